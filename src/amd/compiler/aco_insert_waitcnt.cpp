@@ -9,8 +9,7 @@
 
 #include "common/sid.h"
 
-#include <map>
-#include <stack>
+#include <array>
 #include <vector>
 #include <optional>
 
@@ -165,6 +164,9 @@ private:
    uint8_t counters[num_events] = {};
 };
 
+static constexpr uint16_t gpr_none = UINT16_MAX;
+static constexpr unsigned max_gpr_index = 512;
+
 struct wait_ctx {
    Program* program;
    enum amd_gfx_level gfx_level;
@@ -178,13 +180,51 @@ struct wait_ctx {
    wait_imm barrier_imm[storage_count];
    uint16_t barrier_events[storage_count] = {}; /* use wait_event notion */
 
-   std::map<PhysReg, wait_entry> gpr_map;
+   /* Registers with outstanding writes. The entries are stored densely so that copying and
+    * joining contexts is proportional to the number of pending registers. Lookups go through
+    * gpr_index, which maps each register to its entry (or gpr_none). The table is shared by all
+    * contexts of a program and only bound to one of them at a time (see gpr_index_scope), so
+    * that it isn't copied along with every context.
+    */
+   std::vector<std::pair<PhysReg, wait_entry>> gpr_map;
+   uint16_t* gpr_index = NULL;
 
    wait_ctx() {}
    wait_ctx(Program* program_, const target_info* info_)
        : program(program_), gfx_level(program_->gfx_level), info(info_)
    {}
 
+   wait_entry* find_entry(PhysReg reg)
+   {
+      assert(gpr_index);
+      uint16_t idx = gpr_index[reg.reg()];
+      return idx == gpr_none ? NULL : &gpr_map[idx].second;
+   }
+
+   /* Returns true if the register's entry was created or changed. */
+   bool join_entry(PhysReg reg, const wait_entry& entry)
+   {
+      assert(gpr_index && reg.reg() < max_gpr_index);
+      uint16_t& idx = gpr_index[reg.reg()];
+      if (idx == gpr_none) {
+         idx = gpr_map.size();
+         gpr_map.emplace_back(reg, entry);
+         return true;
+      }
+      return gpr_map[idx].second.join(entry);
+   }
+
+   /* Removes the entry at idx by moving the last entry into its slot. */
+   void remove_entry(unsigned idx)
+   {
+      gpr_index[gpr_map[idx].first.reg()] = gpr_none;
+      if (idx != gpr_map.size() - 1) {
+         gpr_map[idx] = gpr_map.back();
+         gpr_index[gpr_map[idx].first.reg()] = idx;
+      }
+      gpr_map.pop_back();
+   }
+
    bool join(const wait_ctx* other, bool logical)
    {
       bool changed = (other->pending_flat_lgkm && !pending_flat_lgkm) ||
@@ -199,13 +239,7 @@ struct wait_ctx {
          if (entry.second.logical != logical)
             continue;
 
-         using iterator = std::map<PhysReg, wait_entry>::iterator;
-         const std::pair<iterator, bool> insert_pair = gpr_map.insert(entry);
-         if (insert_pair.second) {
-            changed = true;
-         } else {
-            changed |= insert_pair.first->second.join(entry.second);
-         }
+         changed |= join_entry(entry.first, entry.second);
       }
 
       for (unsigned i = 0; i < storage_count; i++) {
@@ -241,6 +275,28 @@ struct wait_ctx {
    }
 };
 
+/* Binds the shared register index table to a context for the lifetime of the scope. The table
+ * must be all gpr_none on entry, and is left that way again when the scope ends.
+ */
+struct gpr_index_scope {
+   wait_ctx& ctx;
+
+   gpr_index_scope(wait_ctx& ctx_, uint16_t* table) : ctx(ctx_)
+   {
+      assert(!ctx.gpr_index);
+      ctx.gpr_index = table;
+      for (unsigned i = 0; i < ctx.gpr_map.size(); i++)
+         table[ctx.gpr_map[i].first.reg()] = i;
+   }
+
+   ~gpr_index_scope()
+   {
+      for (const auto& entry : ctx.gpr_map)
+         ctx.gpr_index[entry.first.reg()] = gpr_none;
+      ctx.gpr_index = NULL;
+   }
+};
+
 wait_event
 get_vmem_event(wait_ctx& ctx, Instruction* instr, uint8_t type)
 {
@@ -261,9 +317,9 @@ check_instr(wait_ctx& ctx, wait_imm& wait, Instruction* instr)
 
       /* check consecutively read gprs */
       for (unsigned j = 0; j < op.size(); j++) {
-         std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.find(PhysReg{op.physReg() + j});
-         if (it != ctx.gpr_map.end() && it->second.wait_on_read)
-            wait.combine(it->second.imm);
+         wait_entry* entry = ctx.find_entry(PhysReg{op.physReg() + j});
+         if (entry && entry->wait_on_read)
+            wait.combine(entry->imm);
       }
    }
 
@@ -272,24 +328,24 @@ check_instr(wait_ctx& ctx, wait_imm& wait, Instruction* instr)
       for (unsigned j = 0; j < def.getTemp().size(); j++) {
          PhysReg reg{def.physReg() + j};
 
-         std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.find(reg);
-         if (it == ctx.gpr_map.end())
+         wait_entry* entry = ctx.find_entry(reg);
+         if (!entry)
             continue;
 
-         wait_imm reg_imm = it->second.imm;
+         wait_imm reg_imm = entry->imm;
 
          /* Vector Memory reads and writes return in the order they were issued */
          uint8_t vmem_type = get_vmem_type(ctx.gfx_level, instr);
          if (vmem_type) {
             wait_event event = get_vmem_event(ctx, instr, vmem_type);
             wait_type type = (wait_type)(ffs(ctx.info->get_counters_for_event(event)) - 1);
-            if ((it->second.events & ctx.info->events[type]) == event &&
-                (type != wait_type_vm || it->second.vmem_types == vmem_type))
+            if ((entry->events & ctx.info->events[type]) == event &&
+                (type != wait_type_vm || entry->vmem_types == vmem_type))
                reg_imm[type] = wait_imm::unset_counter;
          }
 
          /* LDS reads and writes return in the order they were issued. same for GDS */
-         if (instr->isDS() && (it->second.events & ctx.info->events[wait_type_lgkm]) ==
+         if (instr->isDS() && (entry->events & ctx.info->events[wait_type_lgkm]) ==
                                  (instr->ds().gds ? event_gds : event_lds))
             reg_imm.lgkm = wait_imm::unset_counter;
 
@@ -430,16 +486,16 @@ kill(wait_imm& imm, Instruction* instr, wait_ctx& ctx, memory_sync_info sync_inf
       }
 
       /* remove all gprs with higher counter from map */
-      std::map<PhysReg, wait_entry>::iterator it = ctx.gpr_map.begin();
-      while (it != ctx.gpr_map.end()) {
+      for (unsigned idx = 0; idx < ctx.gpr_map.size();) {
+         wait_entry& entry = ctx.gpr_map[idx].second;
          for (unsigned i = 0; i < wait_type_num; i++) {
-            if (imm[i] != wait_imm::unset_counter && imm[i] <= it->second.imm[i])
-               it->second.remove_wait((wait_type)i, ctx.info->events[i]);
+            if (imm[i] != wait_imm::unset_counter && imm[i] <= entry.imm[i])
+               entry.remove_wait((wait_type)i, ctx.info->events[i]);
          }
-         if (!it->second.counters)
-            it = ctx.gpr_map.erase(it);
+         if (!entry.counters)
+            ctx.remove_entry(idx);
          else
-            it++;
+            idx++;
       }
    }
 
@@ -491,7 +547,7 @@ update_counters(wait_ctx& ctx, wait_event event, memory_sync_info sync = memory_
    if (ctx.pending_flat_vm)
       counters &= ~counter_vm;
 
-   for (std::pair<const PhysReg, wait_entry>& e : ctx.gpr_map) {
+   for (std::pair<PhysReg, wait_entry>& e : ctx.gpr_map) {
       wait_entry& entry = e.second;
 
       if (entry.events & ctx.info->unordered_events)
@@ -538,11 +594,8 @@ insert_wait_entry(wait_ctx& ctx, PhysReg reg, RegClass rc, wait_event event, boo
    if (counters & counter_vm)
       new_entry.vmem_types |= vmem_types;
 
-   for (unsigned i = 0; i < rc.size(); i++) {
-      auto it = ctx.gpr_map.emplace(PhysReg{reg.reg() + i}, new_entry);
-      if (!it.second)
-         it.first->second.join(new_entry);
-   }
+   for (unsigned i = 0; i < rc.size(); i++)
+      ctx.join_entry(PhysReg{reg.reg() + i}, new_entry);
 }
 
 void
@@ -783,25 +836,38 @@ insert_waitcnt(Program* program)
    target_info info(program->gfx_level);
 
    /* per BB ctx */
-   std::vector<bool> done(program->blocks.size());
    std::vector<wait_ctx> in_ctx(program->blocks.size(), wait_ctx(program, &info));
-   std::vector<wait_ctx> out_ctx(program->blocks.size(), wait_ctx(program, &info));
 
-   std::stack<unsigned, std::vector<unsigned>> loop_header_indices;
-   unsigned loop_progress = 0;
+   /* Blocks are (re-)processed only if their incoming state changed since the last time they
+    * were handled. The outgoing state of a block is joined directly into its successors, so loops
+    * converge without iterating blocks whose predecessors didn't add anything new.
+    */
+   std::vector<bool> pending(program->blocks.size(), true);
+   unsigned worklist = 0;
+
+   std::array<uint16_t, max_gpr_index> gpr_index;
+   gpr_index.fill(gpr_none);
 
-   if (program->pending_lds_access) {
-      update_barrier_imm(in_ctx[0], info.get_counters_for_event(event_lds), event_lds,
-                         memory_sync_info(storage_shared));
-   }
+   {
+      gpr_index_scope scope(in_ctx[0], gpr_index.data());
 
-   for (Definition def : program->args_pending_vmem) {
-      update_counters(in_ctx[0], event_vmem);
-      insert_wait_entry(in_ctx[0], def, event_vmem);
+      if (program->pending_lds_access) {
+         update_barrier_imm(in_ctx[0], info.get_counters_for_event(event_lds), event_lds,
+                            memory_sync_info(storage_shared));
+      }
+
+      for (Definition def : program->args_pending_vmem) {
+         update_counters(in_ctx[0], event_vmem);
+         insert_wait_entry(in_ctx[0], def, event_vmem);
+      }
    }
 
-   for (unsigned i = 0; i < program->blocks.size();) {
-      Block& current = program->blocks[i++];
+   while (worklist < program->blocks.size()) {
+      Block& current = program->blocks[worklist++];
+
+      if (!pending[current.index])
+         continue;
+      pending[current.index] = false;
 
       if (current.kind & block_kind_discard_early_exit) {
          /* Because the jump to the discard early exit block may happen anywhere in a block, it's
@@ -813,39 +879,25 @@ insert_waitcnt(Program* program)
 
       wait_ctx ctx = in_ctx[current.index];
 
-      if (current.kind & block_kind_loop_header) {
-         loop_header_indices.push(current.index);
-      } else if (current.kind & block_kind_loop_exit) {
-         bool repeat = false;
-         if (loop_progress == loop_header_indices.size()) {
-            i = loop_header_indices.top();
-            repeat = true;
-         }
-         loop_header_indices.pop();
-         loop_progress = std::min<unsigned>(loop_progress, loop_header_indices.size());
-         if (repeat)
-            continue;
+      {
+         gpr_index_scope scope(ctx, gpr_index.data());
+         handle_block(program, current, ctx);
       }
 
-      bool changed = false;
-      for (unsigned b : current.linear_preds)
-         changed |= ctx.join(&out_ctx[b], false);
-      for (unsigned b : current.logical_preds)
-         changed |= ctx.join(&out_ctx[b], true);
-
-      if (done[current.index] && !changed) {
-         in_ctx[current.index] = std::move(ctx);
-         continue;
-      } else {
-         in_ctx[current.index] = ctx;
+      for (unsigned succ : current.linear_succs) {
+         gpr_index_scope scope(in_ctx[succ], gpr_index.data());
+         if (in_ctx[succ].join(&ctx, false)) {
+            pending[succ] = true;
+            worklist = std::min(worklist, succ);
+         }
+      }
+      for (unsigned succ : current.logical_succs) {
+         gpr_index_scope scope(in_ctx[succ], gpr_index.data());
+         if (in_ctx[succ].join(&ctx, true)) {
+            pending[succ] = true;
+            worklist = std::min(worklist, succ);
+         }
       }
-
-      loop_progress = std::max<unsigned>(loop_progress, current.loop_nest_depth);
-      done[current.index] = true;
-
-      handle_block(program, current, ctx);
-
-      out_ctx[current.index] = std::move(ctx);
    }
 }
 
@@ -42,6 +42,10 @@ typedef void(aco_shader_part_callback)(void** priv_ptr, uint32_t num_sgprs, uint
 
 extern const struct aco_compiler_statistic_info* aco_statistic_infos;
 
+/* The aco_compile_* entry points are reentrant: every invocation owns its Program and instruction
+ * allocator (which is thread-local), ACO_DEBUG is parsed exactly once through call_once() and the
+ * statistic infos are immutable. Shaders can therefore be compiled concurrently from any thread.
+ */
 void aco_compile_shader(const struct aco_compiler_options* options,
                         const struct aco_shader_info* info, unsigned shader_count,
                         struct nir_shader* const* shaders, const struct ac_shader_args* args,
@@ -532,3 +532,74 @@ BEGIN_TEST(insert_waitcnt.vmem_ds)
 
    finish_waitcnt_test();
 END_TEST
+
+BEGIN_TEST(insert_waitcnt.nested_loops)
+   if (!setup_cs(NULL, GFX10))
+      return;
+
+   /* Keep many loads outstanding across the back-edges of two nested loops. */
+   const unsigned num_loads = 32;
+   Operand op_v0(PhysReg(256), v1);
+   Operand desc0(PhysReg(0), s4);
+
+   auto add_preds = [](Block* block, std::initializer_list<unsigned> preds)
+   {
+      for (unsigned pred : preds) {
+         block->linear_preds.push_back(pred);
+         block->logical_preds.push_back(pred);
+      }
+   };
+
+   auto emit_loads = [&]()
+   {
+      for (unsigned i = 0; i < num_loads; i++) {
+         bld.mubuf(aco_opcode::buffer_load_dword, Definition(PhysReg(260 + i), v1), desc0, op_v0,
+                   Operand::zero(), 0, false);
+      }
+   };
+
+   //>> BB0
+   //! /* logical preds: / linear preds: / kind: top-level, */
+   //! v1: %0:v[4] = buffer_load_dword %0:s[0-3], %0:v[0], 0
+   emit_loads();
+
+   /* outer loop header */
+   Block* block = program->create_and_insert_block();
+   block->kind |= block_kind_loop_header;
+   add_preds(block, {0, 4});
+
+   /* inner loop header */
+   block = program->create_and_insert_block();
+   block->kind |= block_kind_loop_header;
+   add_preds(block, {1, 3});
+
+   /* inner loop body: reloading the registers in order doesn't need any waits */
+   //>> BB3
+   //! /* logical preds: BB2, / linear preds: BB2, / kind: */
+   //! v1: %0:v[4] = buffer_load_dword %0:s[0-3], %0:v[0], 0
+   //! v1: %0:v[5] = buffer_load_dword %0:s[0-3], %0:v[0], 0
+   block = program->create_and_insert_block();
+   add_preds(block, {2});
+   bld.reset(block);
+   emit_loads();
+
+   /* inner loop exit, outer loop latch */
+   block = program->create_and_insert_block();
+   block->kind |= block_kind_loop_exit;
+   add_preds(block, {3});
+
+   //>> BB5
+   //! /* logical preds: BB4, / linear preds: BB4, / kind: uniform, loop-exit, */
+   //! s_waitcnt vmcnt(31)
+   //! p_unit_test 0, %0:v[4]
+   //! s_waitcnt vmcnt(0)
+   //! p_unit_test 1, %0:v[35]
+   block = program->create_and_insert_block();
+   block->kind |= block_kind_loop_exit;
+   add_preds(block, {4});
+   bld.reset(block);
+   bld.pseudo(aco_opcode::p_unit_test, Operand::c32(0), Operand(PhysReg(260), v1));
+   bld.pseudo(aco_opcode::p_unit_test, Operand::c32(1), Operand(PhysReg(260 + num_loads - 1), v1));
+
+   finish_waitcnt_test();
+END_TEST
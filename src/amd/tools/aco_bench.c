@@ -0,0 +1,828 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Offline compile-time and code-quality benchmark for RADV/ACO.
+ *
+ * Every SPIR-V module found in the given files or directories is compiled
+ * through RADV for the family selected with -f, using the null winsys, so no
+ * GPU is needed. For each shader stage the compile time reported through
+ * VK_EXT_pipeline_creation_feedback and every pipeline executable statistic
+ * (including all ACO statistics) are written out as CSV rows:
+ *
+ *    shader,stage,executable,statistic,value
+ *
+ * Two builds can then be compared by joining their outputs on the first four
+ * columns.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "compiler/spirv/spirv.h"
+#include "util/macros.h"
+#include "vulkan/vulkan_core.h"
+
+PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr(VkInstance instance, const char *pName);
+
+#define FUNCTION_LIST                                                                                                  \
+   ITEM(DestroyInstance)                                                                                               \
+   ITEM(EnumeratePhysicalDevices)                                                                                      \
+   ITEM(CreateDevice)                                                                                                  \
+   ITEM(DestroyDevice)                                                                                                 \
+   ITEM(CreateShaderModule)                                                                                            \
+   ITEM(DestroyShaderModule)                                                                                           \
+   ITEM(CreateDescriptorSetLayout)                                                                                     \
+   ITEM(DestroyDescriptorSetLayout)                                                                                    \
+   ITEM(CreatePipelineLayout)                                                                                          \
+   ITEM(DestroyPipelineLayout)                                                                                         \
+   ITEM(CreateComputePipelines)                                                                                        \
+   ITEM(CreateGraphicsPipelines)                                                                                       \
+   ITEM(DestroyPipeline)                                                                                               \
+   ITEM(GetPipelineExecutablePropertiesKHR)                                                                            \
+   ITEM(GetPipelineExecutableStatisticsKHR)
+
+#define ITEM(n) static PFN_vk##n n;
+FUNCTION_LIST
+#undef ITEM
+
+#define MAX_SETS       32
+#define MAX_BINDINGS   64
+#define MAX_EXECUTABLES 16
+#define MAX_STATISTICS 64
+
+struct bench_binding {
+   uint32_t binding;
+   VkDescriptorType type;
+   uint32_t count;
+};
+
+struct bench_set {
+   struct bench_binding bindings[MAX_BINDINGS];
+   uint32_t binding_count;
+};
+
+struct bench_entrypoint {
+   const char *name;
+   VkShaderStageFlagBits stage;
+};
+
+struct bench_module {
+   const uint32_t *words;
+   size_t num_words;
+
+   struct bench_entrypoint *entrypoints;
+   uint32_t entrypoint_count;
+
+   struct bench_set sets[MAX_SETS];
+   uint32_t set_count;
+   bool uses_push_constants;
+};
+
+/* Per-id information gathered from a single pass over the module. */
+struct spirv_id {
+   uint32_t offset; /* word offset of the defining instruction */
+   uint32_t set;
+   uint32_t binding;
+   bool has_set;
+   bool has_binding;
+   bool buffer_block;
+};
+
+static VkShaderStageFlagBits
+execution_model_to_stage(SpvExecutionModel model)
+{
+   switch (model) {
+   case SpvExecutionModelVertex:
+      return VK_SHADER_STAGE_VERTEX_BIT;
+   case SpvExecutionModelTessellationControl:
+      return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+   case SpvExecutionModelTessellationEvaluation:
+      return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+   case SpvExecutionModelGeometry:
+      return VK_SHADER_STAGE_GEOMETRY_BIT;
+   case SpvExecutionModelFragment:
+      return VK_SHADER_STAGE_FRAGMENT_BIT;
+   case SpvExecutionModelGLCompute:
+      return VK_SHADER_STAGE_COMPUTE_BIT;
+   default:
+      return 0;
+   }
+}
+
+static const char *
+stage_to_string(VkShaderStageFlagBits stage)
+{
+   switch (stage) {
+   case VK_SHADER_STAGE_VERTEX_BIT:
+      return "vertex";
+   case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+      return "tess_ctrl";
+   case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+      return "tess_eval";
+   case VK_SHADER_STAGE_GEOMETRY_BIT:
+      return "geometry";
+   case VK_SHADER_STAGE_FRAGMENT_BIT:
+      return "fragment";
+   case VK_SHADER_STAGE_COMPUTE_BIT:
+      return "compute";
+   default:
+      return "unknown";
+   }
+}
+
+static bool
+get_descriptor_type(const uint32_t *words, const struct spirv_id *ids, uint32_t type_id, SpvStorageClass storage,
+                    VkDescriptorType *type, uint32_t *count)
+{
+   *count = 1;
+
+   for (;;) {
+      const uint32_t *insn = &words[ids[type_id].offset];
+      SpvOp op = insn[0] & SpvOpCodeMask;
+
+      switch (op) {
+      case SpvOpTypeArray: {
+         const uint32_t *length = &words[ids[insn[3]].offset];
+         if ((length[0] & SpvOpCodeMask) == SpvOpConstant)
+            *count *= length[3];
+         type_id = insn[2];
+         break;
+      }
+      case SpvOpTypeRuntimeArray:
+         type_id = insn[2];
+         break;
+      case SpvOpTypeImage: {
+         const SpvDim dim = insn[3];
+         const uint32_t sampled = insn[7];
+         if (dim == SpvDimSubpassData)
+            *type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+         else if (dim == SpvDimBuffer)
+            *type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+         else
+            *type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+         return true;
+      }
+      case SpvOpTypeSampler:
+         *type = VK_DESCRIPTOR_TYPE_SAMPLER;
+         return true;
+      case SpvOpTypeSampledImage:
+         *type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+         return true;
+      case SpvOpTypeStruct:
+         if (storage == SpvStorageClassStorageBuffer || ids[type_id].buffer_block)
+            *type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+         else
+            *type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+         return true;
+      default:
+         /* Acceleration structures and other descriptor types aren't supported. */
+         return false;
+      }
+   }
+}
+
+static bool
+add_binding(struct bench_module *module, uint32_t set, uint32_t binding, VkDescriptorType type, uint32_t count)
+{
+   if (set >= MAX_SETS)
+      return false;
+
+   struct bench_set *s = &module->sets[set];
+   for (uint32_t i = 0; i < s->binding_count; i++) {
+      if (s->bindings[i].binding == binding) {
+         /* Aliased bindings must have the same type. */
+         s->bindings[i].count = MAX2(s->bindings[i].count, count);
+         return s->bindings[i].type == type;
+      }
+   }
+
+   if (s->binding_count == MAX_BINDINGS)
+      return false;
+
+   s->bindings[s->binding_count++] = (struct bench_binding){binding, type, count};
+   module->set_count = MAX2(module->set_count, set + 1);
+   return true;
+}
+
+/* Gathers the entrypoints and the descriptor bindings used by the module, which is just enough to create a
+ * compatible pipeline layout.
+ */
+static bool
+reflect_module(struct bench_module *module)
+{
+   const uint32_t *words = module->words;
+
+   if (module->num_words < 5 || words[0] != SpvMagicNumber)
+      return false;
+
+   const uint32_t bound = words[3];
+   struct spirv_id *ids = calloc(bound, sizeof(*ids));
+   module->entrypoints = calloc(module->num_words, sizeof(*module->entrypoints));
+   if (!ids || !module->entrypoints) {
+      free(ids);
+      return false;
+   }
+
+   bool ok = true;
+
+   /* First pass: record where every id is defined and how it is decorated. */
+   for (size_t w = 5; w < module->num_words;) {
+      const uint32_t *insn = &words[w];
+      const uint32_t len = insn[0] >> SpvWordCountShift;
+      const SpvOp op = insn[0] & SpvOpCodeMask;
+
+      if (len == 0 || w + len > module->num_words) {
+         ok = false;
+         break;
+      }
+
+      switch (op) {
+      case SpvOpEntryPoint: {
+         VkShaderStageFlagBits stage = execution_model_to_stage(insn[1]);
+         if (stage) {
+            module->entrypoints[module->entrypoint_count++] = (struct bench_entrypoint){
+               .name = (const char *)&insn[3],
+               .stage = stage,
+            };
+         }
+         break;
+      }
+      case SpvOpDecorate:
+         if (insn[1] >= bound)
+            break;
+         if (insn[2] == SpvDecorationDescriptorSet) {
+            ids[insn[1]].set = insn[3];
+            ids[insn[1]].has_set = true;
+         } else if (insn[2] == SpvDecorationBinding) {
+            ids[insn[1]].binding = insn[3];
+            ids[insn[1]].has_binding = true;
+         } else if (insn[2] == SpvDecorationBufferBlock) {
+            ids[insn[1]].buffer_block = true;
+         }
+         break;
+      case SpvOpTypeImage:
+      case SpvOpTypeSampler:
+      case SpvOpTypeSampledImage:
+      case SpvOpTypeStruct:
+      case SpvOpTypeRuntimeArray:
+      case SpvOpTypePointer:
+         if (insn[1] < bound)
+            ids[insn[1]].offset = w;
+         break;
+      case SpvOpTypeArray:
+      case SpvOpConstant:
+      case SpvOpVariable:
+         if (insn[op == SpvOpTypeArray ? 1 : 2] < bound)
+            ids[insn[op == SpvOpTypeArray ? 1 : 2]].offset = w;
+         break;
+      default:
+         break;
+      }
+
+      w += len;
+   }
+
+   /* Second pass: turn the global resource variables into bindings. */
+   for (uint32_t id = 0; ok && id < bound; id++) {
+      const uint32_t *insn = &words[ids[id].offset];
+      if (!ids[id].offset || (insn[0] & SpvOpCodeMask) != SpvOpVariable)
+         continue;
+
+      const SpvStorageClass storage = insn[3];
+      if (storage == SpvStorageClassPushConstant) {
+         module->uses_push_constants = true;
+         continue;
+      }
+
+      if (!ids[id].has_set || !ids[id].has_binding)
+         continue;
+
+      const uint32_t *ptr_type = &words[ids[insn[1]].offset];
+      VkDescriptorType type;
+      uint32_t count;
+
+      if (!get_descriptor_type(words, ids, ptr_type[3], storage, &type, &count) ||
+          !add_binding(module, ids[id].set, ids[id].binding, type, count))
+         ok = false;
+   }
+
+   free(ids);
+   return ok && module->entrypoint_count;
+}
+
+struct bench_ctx {
+   VkInstance instance;
+   VkDevice device;
+   FILE *out;
+   unsigned repeat;
+};
+
+static VkPipelineLayout
+create_pipeline_layout(struct bench_ctx *ctx, const struct bench_module *module, VkDescriptorSetLayout *set_layouts)
+{
+   VkPipelineLayout layout = VK_NULL_HANDLE;
+
+   for (uint32_t s = 0; s < module->set_count; s++) {
+      VkDescriptorSetLayoutBinding bindings[MAX_BINDINGS];
+      const struct bench_set *set = &module->sets[s];
+
+      for (uint32_t b = 0; b < set->binding_count; b++) {
+         bindings[b] = (VkDescriptorSetLayoutBinding){
+            .binding = set->bindings[b].binding,
+            .descriptorType = set->bindings[b].type,
+            .descriptorCount = set->bindings[b].count,
+            .stageFlags = VK_SHADER_STAGE_ALL,
+         };
+      }
+
+      const VkDescriptorSetLayoutCreateInfo set_info = {
+         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+         .bindingCount = set->binding_count,
+         .pBindings = bindings,
+      };
+      if (CreateDescriptorSetLayout(ctx->device, &set_info, NULL, &set_layouts[s]) != VK_SUCCESS)
+         return VK_NULL_HANDLE;
+   }
+
+   const VkPushConstantRange push_constants = {
+      .stageFlags = VK_SHADER_STAGE_ALL,
+      .offset = 0,
+      .size = 128,
+   };
+   const VkPipelineLayoutCreateInfo layout_info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+      .setLayoutCount = module->set_count,
+      .pSetLayouts = set_layouts,
+      .pushConstantRangeCount = module->uses_push_constants ? 1 : 0,
+      .pPushConstantRanges = &push_constants,
+   };
+   CreatePipelineLayout(ctx->device, &layout_info, NULL, &layout);
+   return layout;
+}
+
+static VkResult
+compile_stage(struct bench_ctx *ctx, VkShaderModule shader_module, VkPipelineLayout layout,
+              const struct bench_entrypoint *entrypoint, VkPipeline *pipeline, uint64_t *duration_ns)
+{
+   VkPipelineCreationFeedback stage_feedback = {0};
+   VkPipelineCreationFeedback pipeline_feedback = {0};
+   const VkPipelineCreationFeedbackCreateInfo feedback_info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+      .pPipelineCreationFeedback = &pipeline_feedback,
+      .pipelineStageCreationFeedbackCount = 1,
+      .pPipelineStageCreationFeedbacks = &stage_feedback,
+   };
+   const VkPipelineShaderStageCreateInfo stage_info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = entrypoint->stage,
+      .module = shader_module,
+      .pName = entrypoint->name,
+   };
+   VkResult result;
+
+   if (entrypoint->stage == VK_SHADER_STAGE_COMPUTE_BIT) {
+      const VkComputePipelineCreateInfo info = {
+         .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+         .pNext = &feedback_info,
+         .flags = VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR,
+         .stage = stage_info,
+         .layout = layout,
+      };
+      result = CreateComputePipelines(ctx->device, VK_NULL_HANDLE, 1, &info, NULL, pipeline);
+   } else if (entrypoint->stage == VK_SHADER_STAGE_VERTEX_BIT ||
+              entrypoint->stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+      /* Graphics stages are compiled on their own as graphics pipeline libraries. */
+      const bool is_fs = entrypoint->stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+      const VkFormat color_format = VK_FORMAT_R8G8B8A8_UNORM;
+      const VkPipelineRenderingCreateInfo rendering_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+         .pNext = &feedback_info,
+         .colorAttachmentCount = 1,
+         .pColorAttachmentFormats = &color_format,
+      };
+      const VkGraphicsPipelineLibraryCreateInfoEXT library_info = {
+         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+         .pNext = &rendering_info,
+         .flags = is_fs ? VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT
+                        : VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+      };
+      const VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+      const VkPipelineDynamicStateCreateInfo dynamic_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+         .dynamicStateCount = ARRAY_SIZE(dynamic_states),
+         .pDynamicStates = dynamic_states,
+      };
+      const VkPipelineViewportStateCreateInfo viewport_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+         .viewportCount = 1,
+         .scissorCount = 1,
+      };
+      const VkPipelineRasterizationStateCreateInfo raster_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+         .polygonMode = VK_POLYGON_MODE_FILL,
+         .cullMode = VK_CULL_MODE_NONE,
+         .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+         .lineWidth = 1.0f,
+      };
+      const VkPipelineMultisampleStateCreateInfo ms_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+         .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+      };
+      const VkPipelineDepthStencilStateCreateInfo ds_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+      };
+      const VkGraphicsPipelineCreateInfo info = {
+         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+         .pNext = &library_info,
+         .flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR,
+         .stageCount = 1,
+         .pStages = &stage_info,
+         .pViewportState = is_fs ? NULL : &viewport_info,
+         .pRasterizationState = is_fs ? NULL : &raster_info,
+         .pMultisampleState = is_fs ? &ms_info : NULL,
+         .pDepthStencilState = is_fs ? &ds_info : NULL,
+         .pDynamicState = is_fs ? NULL : &dynamic_info,
+         .layout = layout,
+      };
+      result = CreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1, &info, NULL, pipeline);
+   } else {
+      return VK_ERROR_FEATURE_NOT_PRESENT;
+   }
+
+   *duration_ns = stage_feedback.duration;
+   return result;
+}
+
+static void
+print_statistics(struct bench_ctx *ctx, const char *shader, const struct bench_entrypoint *entrypoint,
+                 VkPipeline pipeline)
+{
+   const VkPipelineInfoKHR pipeline_info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR,
+      .pipeline = pipeline,
+   };
+   VkPipelineExecutablePropertiesKHR executables[MAX_EXECUTABLES];
+   uint32_t executable_count = MAX_EXECUTABLES;
+
+   for (uint32_t i = 0; i < executable_count; i++)
+      executables[i] = (VkPipelineExecutablePropertiesKHR){VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_PROPERTIES_KHR};
+
+   if (GetPipelineExecutablePropertiesKHR(ctx->device, &pipeline_info, &executable_count, executables) < 0)
+      return;
+
+   for (uint32_t e = 0; e < executable_count; e++) {
+      const VkPipelineExecutableInfoKHR exec_info = {
+         .sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INFO_KHR,
+         .pipeline = pipeline,
+         .executableIndex = e,
+      };
+      VkPipelineExecutableStatisticKHR stats[MAX_STATISTICS];
+      uint32_t stat_count = MAX_STATISTICS;
+
+      for (uint32_t i = 0; i < stat_count; i++)
+         stats[i] = (VkPipelineExecutableStatisticKHR){VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_STATISTIC_KHR};
+
+      if (GetPipelineExecutableStatisticsKHR(ctx->device, &exec_info, &stat_count, stats) < 0)
+         continue;
+
+      for (uint32_t i = 0; i < stat_count; i++) {
+         fprintf(ctx->out, "%s,%s,%s,%s,", shader, stage_to_string(entrypoint->stage), executables[e].name,
+                 stats[i].name);
+
+         switch (stats[i].format) {
+         case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR:
+            fprintf(ctx->out, "%u\n", stats[i].value.b32);
+            break;
+         case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:
+            fprintf(ctx->out, "%" PRIi64 "\n", stats[i].value.i64);
+            break;
+         case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR:
+            fprintf(ctx->out, "%" PRIu64 "\n", stats[i].value.u64);
+            break;
+         case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_FLOAT64_KHR:
+            fprintf(ctx->out, "%f\n", stats[i].value.f64);
+            break;
+         default:
+            fprintf(ctx->out, "\n");
+            break;
+         }
+      }
+   }
+}
+
+static void *
+read_file(const char *path, size_t *size)
+{
+   FILE *f = fopen(path, "rb");
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   long len = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   void *data = len > 0 ? malloc(len) : NULL;
+   if (data && fread(data, 1, len, f) != (size_t)len) {
+      free(data);
+      data = NULL;
+   }
+   fclose(f);
+
+   *size = len;
+   return data;
+}
+
+static bool
+bench_file(struct bench_ctx *ctx, const char *path)
+{
+   struct bench_module module = {0};
+   size_t size;
+   uint32_t *words = read_file(path, &size);
+   bool ok = false;
+
+   if (!words || size % 4) {
+      fprintf(stderr, "%s: failed to read SPIR-V\n", path);
+      free(words);
+      return false;
+   }
+
+   module.words = words;
+   module.num_words = size / 4;
+
+   if (!reflect_module(&module)) {
+      fprintf(stderr, "%s: unsupported SPIR-V module\n", path);
+      goto fail;
+   }
+
+   const VkShaderModuleCreateInfo module_info = {
+      .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+      .codeSize = size,
+      .pCode = words,
+   };
+   VkShaderModule shader_module;
+   if (CreateShaderModule(ctx->device, &module_info, NULL, &shader_module) != VK_SUCCESS)
+      goto fail;
+
+   VkDescriptorSetLayout set_layouts[MAX_SETS] = {0};
+   VkPipelineLayout layout = create_pipeline_layout(ctx, &module, set_layouts);
+
+   ok = layout != VK_NULL_HANDLE;
+   for (uint32_t i = 0; ok && i < module.entrypoint_count; i++) {
+      const struct bench_entrypoint *entrypoint = &module.entrypoints[i];
+      uint64_t min_duration = UINT64_MAX;
+      VkPipeline pipeline = VK_NULL_HANDLE;
+
+      for (unsigned r = 0; r < ctx->repeat; r++) {
+         uint64_t duration = 0;
+
+         if (pipeline)
+            DestroyPipeline(ctx->device, pipeline, NULL);
+         pipeline = VK_NULL_HANDLE;
+
+         VkResult result = compile_stage(ctx, shader_module, layout, entrypoint, &pipeline, &duration);
+         if (result == VK_ERROR_FEATURE_NOT_PRESENT) {
+            fprintf(stderr, "%s: skipping %s stage\n", path, stage_to_string(entrypoint->stage));
+            break;
+         } else if (result != VK_SUCCESS) {
+            fprintf(stderr, "%s: failed to compile %s stage\n", path, stage_to_string(entrypoint->stage));
+            ok = false;
+            break;
+         }
+
+         min_duration = MIN2(min_duration, duration);
+      }
+
+      if (pipeline) {
+         fprintf(ctx->out, "%s,%s,,Compile time (us),%" PRIu64 "\n", path, stage_to_string(entrypoint->stage),
+                 min_duration / 1000);
+         print_statistics(ctx, path, entrypoint, pipeline);
+         DestroyPipeline(ctx->device, pipeline, NULL);
+      }
+   }
+
+   if (layout)
+      DestroyPipelineLayout(ctx->device, layout, NULL);
+   for (uint32_t s = 0; s < module.set_count; s++) {
+      if (set_layouts[s])
+         DestroyDescriptorSetLayout(ctx->device, set_layouts[s], NULL);
+   }
+   DestroyShaderModule(ctx->device, shader_module, NULL);
+
+fail:
+   free(module.entrypoints);
+   free(words);
+   return ok;
+}
+
+static int
+compare_strings(const void *a, const void *b)
+{
+   return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static unsigned
+bench_path(struct bench_ctx *ctx, const char *path)
+{
+   struct stat st;
+   if (stat(path, &st)) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      return 1;
+   }
+
+   if (!S_ISDIR(st.st_mode))
+      return bench_file(ctx, path) ? 0 : 1;
+
+   DIR *dir = opendir(path);
+   if (!dir)
+      return 1;
+
+   /* Sort the entries so that the output of two runs can be compared line by line. */
+   char **entries = NULL;
+   unsigned num_entries = 0, failures = 0;
+   struct dirent *entry;
+   while ((entry = readdir(dir))) {
+      if (entry->d_name[0] == '.')
+         continue;
+
+      /* Keep the entries gathered so far if growing the array fails, they're still freed below. */
+      char **tmp = realloc(entries, (num_entries + 1) * sizeof(*entries));
+      if (!tmp) {
+         failures++;
+         break;
+      }
+      entries = tmp;
+
+      if (asprintf(&entries[num_entries], "%s/%s", path, entry->d_name) < 0) {
+         failures++;
+         break;
+      }
+      num_entries++;
+   }
+   closedir(dir);
+
+   qsort(entries, num_entries, sizeof(*entries), compare_strings);
+
+   for (unsigned i = 0; i < num_entries; i++) {
+      const char *name = entries[i];
+      size_t len = strlen(name);
+
+      if (stat(name, &st) == 0 && S_ISDIR(st.st_mode))
+         failures += bench_path(ctx, name);
+      else if (len > 4 && !strcmp(name + len - 4, ".spv"))
+         failures += !bench_file(ctx, name);
+      free(entries[i]);
+   }
+   free(entries);
+
+   return failures;
+}
+
+static bool
+create_device(struct bench_ctx *ctx)
+{
+   const VkApplicationInfo app_info = {
+      .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+      .pApplicationName = "aco_bench",
+      .apiVersion = VK_API_VERSION_1_3,
+   };
+   const VkInstanceCreateInfo instance_info = {
+      .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+      .pApplicationInfo = &app_info,
+   };
+   PFN_vkCreateInstance CreateInstance = (PFN_vkCreateInstance)vk_icdGetInstanceProcAddr(NULL, "vkCreateInstance");
+   if (CreateInstance(&instance_info, NULL, &ctx->instance) != VK_SUCCESS)
+      return false;
+
+#define ITEM(n) n = (PFN_vk##n)vk_icdGetInstanceProcAddr(ctx->instance, "vk" #n);
+   FUNCTION_LIST
+#undef ITEM
+
+   uint32_t device_count = 1;
+   VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+   if (EnumeratePhysicalDevices(ctx->instance, &device_count, &physical_device) < 0 || !device_count)
+      return false;
+
+   VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gpl_features = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+      .graphicsPipelineLibrary = VK_TRUE,
+   };
+   VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR executable_features = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR,
+      .pNext = &gpl_features,
+      .pipelineExecutableInfo = VK_TRUE,
+   };
+   VkPhysicalDeviceVulkan13Features features13 = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+      .pNext = &executable_features,
+      .dynamicRendering = VK_TRUE,
+   };
+   static const char *extensions[] = {
+      "VK_KHR_pipeline_executable_properties",
+      "VK_KHR_pipeline_library",
+      "VK_EXT_graphics_pipeline_library",
+   };
+   const VkDeviceCreateInfo device_info = {
+      .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+      .pNext = &features13,
+      .enabledExtensionCount = ARRAY_SIZE(extensions),
+      .ppEnabledExtensionNames = extensions,
+   };
+
+   return CreateDevice(physical_device, &device_info, NULL, &ctx->device) == VK_SUCCESS;
+}
+
+static void
+print_usage(const char *name)
+{
+   fprintf(stderr,
+           "Usage: %s -f <family> [-r <repeat>] [-o <output.csv>] <file.spv|directory>...\n"
+           "\n"
+           "   -f, --family   GPU family to compile for, e.g. navi21 (see RADV_FORCE_FAMILY)\n"
+           "   -r, --repeat   compile every shader this many times and report the fastest\n"
+           "   -o, --output   write the CSV to this file instead of stdout\n",
+           name);
+}
+
+int
+main(int argc, char **argv)
+{
+   static const struct option long_options[] = {
+      {"family", required_argument, NULL, 'f'},
+      {"repeat", required_argument, NULL, 'r'},
+      {"output", required_argument, NULL, 'o'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+   };
+   struct bench_ctx ctx = {
+      .out = stdout,
+      .repeat = 1,
+   };
+   const char *family = NULL;
+   int c;
+
+   while ((c = getopt_long(argc, argv, "f:r:o:h", long_options, NULL)) != -1) {
+      switch (c) {
+      case 'f':
+         family = optarg;
+         break;
+      case 'r':
+         ctx.repeat = MAX2(atoi(optarg), 1);
+         break;
+      case 'o':
+         ctx.out = fopen(optarg, "w");
+         if (!ctx.out) {
+            fprintf(stderr, "%s: %s\n", optarg, strerror(errno));
+            return EXIT_FAILURE;
+         }
+         break;
+      default:
+         print_usage(argv[0]);
+         return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+
+   if (!family || optind == argc) {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   /* Use the null winsys and make sure every iteration really compiles. */
+   setenv("RADV_FORCE_FAMILY", family, 1);
+   setenv("MESA_SHADER_CACHE_DISABLE", "true", 1);
+
+   const char *debug = getenv("RADV_DEBUG");
+   char *radv_debug = NULL;
+   if (asprintf(&radv_debug, "%s%snocache", debug ? debug : "", debug ? "," : "") < 0)
+      return EXIT_FAILURE;
+   setenv("RADV_DEBUG", radv_debug, 1);
+   free(radv_debug);
+
+   if (!create_device(&ctx)) {
+      fprintf(stderr, "Failed to create a RADV device for %s\n", family);
+      return EXIT_FAILURE;
+   }
+
+   fprintf(ctx.out, "shader,stage,executable,statistic,value\n");
+
+   unsigned failures = 0;
+   for (int i = optind; i < argc; i++)
+      failures += bench_path(&ctx, argv[i]);
+
+   DestroyDevice(ctx.device, NULL);
+   DestroyInstance(ctx.instance, NULL);
+
+   if (ctx.out != stdout)
+      fclose(ctx.out);
+
+   return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
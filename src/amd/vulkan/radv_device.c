@@ -1101,6 +1101,7 @@ radv_CreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCr
    simple_mtx_init(&device->pstate_mtx, mtx_plain);
    simple_mtx_init(&device->rt_handles_mtx, mtx_plain);
    simple_mtx_init(&device->pso_cache_stats_mtx, mtx_plain);
+   device->shader_compile_queue_once = (util_once_flag)UTIL_ONCE_FLAG_INIT;
 
    device->rt_handles = _mesa_hash_table_create(NULL, _mesa_hash_u32, _mesa_key_u32_equal);
 
@@ -1336,6 +1337,7 @@ fail:
    radv_device_finish_border_color(device);
 
    radv_destroy_shader_upload_queue(device);
+   radv_destroy_shader_compile_queue(device);
 
 fail_queue:
    for (unsigned i = 0; i < RADV_MAX_QUEUE_FAMILIES; i++) {
@@ -1406,6 +1408,7 @@ radv_DestroyDevice(VkDevice _device, const VkAllocationCallbacks *pAllocator)
    radv_device_finish_memory_cache(device);
 
    radv_destroy_shader_upload_queue(device);
+   radv_destroy_shader_compile_queue(device);
 
    for (unsigned i = 0; i < RADV_NUM_HW_CTX; i++) {
       if (device->hw_ctx[i])
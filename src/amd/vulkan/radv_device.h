@@ -16,6 +16,8 @@
 #include "ac_sqtt.h"
 
 #include "util/mesa-blake3.h"
+#include "util/u_call_once.h"
+#include "util/u_queue.h"
 
 #include "radv_pipeline.h"
 #include "radv_printf.h"
@@ -438,6 +440,13 @@ struct radv_device {
    mtx_t shader_dma_submission_list_mutex;
    cnd_t shader_dma_submission_list_cond;
 
+   /* Worker threads used to compile independent ray tracing stages of a single pipeline in parallel.
+    * Created on the first compilation that can use them.
+    */
+   util_once_flag shader_compile_queue_once;
+   struct util_queue shader_compile_queue;
+   bool shader_compile_queue_enabled;
+
    /* Whether to DMA shaders to invisible VRAM or to upload directly through BAR. */
    bool shader_use_invisible_vram;
 
@@ -2290,6 +2290,70 @@ radv_create_gs_copy_shader(struct radv_device *device, struct vk_pipeline_cache
    return copy_shader;
 }
 
+struct radv_graphics_nir_to_asm_job {
+   gl_shader_stage stage;
+   nir_shader *nir_shaders[2];
+   unsigned shader_count;
+};
+
+struct radv_graphics_nir_to_asm_ctx {
+   struct radv_device *device;
+   struct vk_pipeline_cache *cache;
+   struct radv_shader_stage *stages;
+   const struct radv_graphics_state_key *gfx_state;
+   bool keep_executable_info;
+   bool keep_statistic_info;
+   bool skip_shaders_cache;
+   struct radv_shader **shaders;
+   struct radv_shader_binary **binaries;
+   struct radv_shader **gs_copy_shader;
+   struct radv_shader_binary **gs_copy_binary;
+   struct radv_graphics_nir_to_asm_job jobs[MESA_VULKAN_SHADER_STAGES];
+   unsigned job_count;
+};
+
+static void
+radv_graphics_shader_nir_to_asm(void *data, unsigned idx)
+{
+   struct radv_graphics_nir_to_asm_ctx *ctx = data;
+   const struct radv_graphics_nir_to_asm_job *job = &ctx->jobs[idx];
+   struct radv_device *device = ctx->device;
+   const struct radv_physical_device *pdev = radv_device_physical(device);
+   struct radv_instance *instance = radv_physical_device_instance(pdev);
+   struct radv_shader_stage *stages = ctx->stages;
+   nir_shader *const *nir_shaders = job->nir_shaders;
+   const unsigned shader_count = job->shader_count;
+   const gl_shader_stage s = job->stage;
+
+   int64_t stage_start = os_time_get_nano();
+
+   bool dump_shader = radv_can_dump_shader(device, nir_shaders[0], false);
+
+   if (dump_shader) {
+      simple_mtx_lock(&instance->shader_dump_mtx);
+      for (uint32_t i = 0; i < shader_count; i++)
+         nir_print_shader(nir_shaders[i], stderr);
+   }
+
+   ctx->binaries[s] = radv_shader_nir_to_asm(device, &stages[s], nir_shaders, shader_count,
+                                             ctx->gfx_state, ctx->keep_executable_info, ctx->keep_statistic_info);
+   ctx->shaders[s] = radv_shader_create(device, ctx->cache, ctx->binaries[s], ctx->skip_shaders_cache || dump_shader);
+
+   radv_shader_generate_debug_info(device, dump_shader, ctx->keep_executable_info, ctx->binaries[s], ctx->shaders[s],
+                                   nir_shaders, shader_count, &stages[s].info);
+
+   if (dump_shader)
+      simple_mtx_unlock(&instance->shader_dump_mtx);
+
+   if (s == MESA_SHADER_GEOMETRY && !stages[s].info.is_ngg) {
+      *ctx->gs_copy_shader = radv_create_gs_copy_shader(
+         device, ctx->cache, &stages[MESA_SHADER_GEOMETRY], ctx->gfx_state, ctx->keep_executable_info,
+         ctx->keep_statistic_info, ctx->skip_shaders_cache, ctx->gs_copy_binary);
+   }
+
+   stages[s].feedback.duration += os_time_get_nano() - stage_start;
+}
+
 static void
 radv_graphics_shaders_nir_to_asm(struct radv_device *device, struct vk_pipeline_cache *cache,
                                  struct radv_shader_stage *stages, const struct radv_graphics_state_key *gfx_state,
@@ -2299,14 +2363,30 @@ radv_graphics_shaders_nir_to_asm(struct radv_device *device, struct vk_pipeline_
                                  struct radv_shader_binary **gs_copy_binary)
 {
    const struct radv_physical_device *pdev = radv_device_physical(device);
-   struct radv_instance *instance = radv_physical_device_instance(pdev);
+   struct radv_graphics_nir_to_asm_ctx ctx = {
+      .device = device,
+      .cache = cache,
+      .stages = stages,
+      .gfx_state = gfx_state,
+      .keep_executable_info = keep_executable_info,
+      .keep_statistic_info = keep_statistic_info,
+      .skip_shaders_cache = skip_shaders_cache,
+      .shaders = shaders,
+      .binaries = binaries,
+      .gs_copy_shader = gs_copy_shader,
+      .gs_copy_binary = gs_copy_binary,
+   };
 
    for (int s = MESA_VULKAN_SHADER_STAGES - 1; s >= 0; s--) {
       if (!(active_nir_stages & (1 << s)))
          continue;
 
-      nir_shader *nir_shaders[2] = {stages[s].nir, NULL};
-      unsigned shader_count = 1;
+      struct radv_graphics_nir_to_asm_job *job = &ctx.jobs[ctx.job_count++];
+
+      job->stage = s;
+      job->nir_shaders[0] = stages[s].nir;
+      job->nir_shaders[1] = NULL;
+      job->shader_count = 1;
 
       /* On GFX9+, TES is merged with GS and VS is merged with TCS or GS. */
       if (pdev->info.gfx_level >= GFX9 &&
@@ -2321,43 +2401,18 @@ radv_graphics_shaders_nir_to_asm(struct radv_device *device, struct vk_pipeline_
             pre_stage = MESA_SHADER_VERTEX;
          }
 
-         nir_shaders[0] = stages[pre_stage].nir;
-         nir_shaders[1] = stages[s].nir;
-         shader_count = 2;
+         job->nir_shaders[0] = stages[pre_stage].nir;
+         job->nir_shaders[1] = stages[s].nir;
+         job->shader_count = 2;
       }
 
-      int64_t stage_start = os_time_get_nano();
-
-      bool dump_shader = radv_can_dump_shader(device, nir_shaders[0], false);
-
-      if (dump_shader) {
-         simple_mtx_lock(&instance->shader_dump_mtx);
-         for (uint32_t i = 0; i < shader_count; i++)
-            nir_print_shader(nir_shaders[i], stderr);
-      }
-
-      binaries[s] = radv_shader_nir_to_asm(device, &stages[s], nir_shaders, shader_count, gfx_state,
-                                           keep_executable_info, keep_statistic_info);
-      shaders[s] = radv_shader_create(device, cache, binaries[s], skip_shaders_cache || dump_shader);
-
-      radv_shader_generate_debug_info(device, dump_shader, keep_executable_info, binaries[s], shaders[s], nir_shaders,
-                                      shader_count, &stages[s].info);
-
-      if (dump_shader)
-         simple_mtx_unlock(&instance->shader_dump_mtx);
-
-      if (s == MESA_SHADER_GEOMETRY && !stages[s].info.is_ngg) {
-         *gs_copy_shader =
-            radv_create_gs_copy_shader(device, cache, &stages[MESA_SHADER_GEOMETRY], gfx_state, keep_executable_info,
-                                       keep_statistic_info, skip_shaders_cache, gs_copy_binary);
-      }
-
-      stages[s].feedback.duration += os_time_get_nano() - stage_start;
-
-      active_nir_stages &= ~(1 << nir_shaders[0]->info.stage);
-      if (nir_shaders[1])
-         active_nir_stages &= ~(1 << nir_shaders[1]->info.stage);
+      active_nir_stages &= ~(1 << job->nir_shaders[0]->info.stage);
+      if (job->nir_shaders[1])
+         active_nir_stages &= ~(1 << job->nir_shaders[1]->info.stage);
    }
+
+   /* Once linked, every (merged) stage is compiled on its own. */
+   radv_shader_compile_parallel(device, ctx.job_count, radv_graphics_shader_nir_to_asm, &ctx);
 }
 
 static void
@@ -2554,6 +2609,50 @@ radv_skip_graphics_pipeline_compile(const struct radv_device *device, const VkGr
    return binary_stages == active_stages;
 }
 
+struct radv_graphics_spirv_to_nir_ctx {
+   struct radv_device *device;
+   struct vk_pipeline_cache *cache;
+   struct radv_shader_stage *stages;
+   const struct radv_graphics_state_key *gfx_state;
+   bool is_internal;
+   gl_shader_stage stages_to_translate[MESA_VULKAN_SHADER_STAGES];
+   unsigned stage_count;
+};
+
+static void
+radv_graphics_shader_spirv_to_nir(void *data, unsigned idx)
+{
+   struct radv_graphics_spirv_to_nir_ctx *ctx = data;
+   struct radv_device *device = ctx->device;
+   const struct radv_physical_device *pdev = radv_device_physical(device);
+   const struct radv_instance *instance = radv_physical_device_instance(pdev);
+   const struct radv_graphics_state_key *gfx_state = ctx->gfx_state;
+   const bool nir_cache = instance->perftest_flags & RADV_PERFTEST_NIR_CACHE;
+   const gl_shader_stage s = ctx->stages_to_translate[idx];
+   struct radv_shader_stage *stage = &ctx->stages[s];
+
+   int64_t stage_start = os_time_get_nano();
+
+   struct radv_spirv_to_nir_options options = {
+      .lower_view_index_to_zero = !gfx_state->has_multiview_view_index,
+      .fix_dual_src_mrt1_export = gfx_state->ps.epilog.mrt0_is_dual_src && instance->drirc.dual_color_blend_by_location,
+      .lower_view_index_to_device_index = stage->key.view_index_from_device_index,
+   };
+   blake3_hash key;
+
+   if (nir_cache) {
+      radv_hash_graphics_spirv_to_nir(key, stage, &options);
+      stage->nir = radv_pipeline_cache_lookup_nir(device, ctx->cache, s, key);
+   }
+   if (!stage->nir) {
+      stage->nir = radv_shader_spirv_to_nir(device, stage, &options, ctx->is_internal);
+      if (nir_cache)
+         radv_pipeline_cache_insert_nir(device, ctx->cache, key, stage->nir);
+   }
+
+   stage->feedback.duration += os_time_get_nano() - stage_start;
+}
+
 void
 radv_graphics_shaders_compile(struct radv_device *device, struct vk_pipeline_cache *cache,
                               struct radv_shader_stage *stages, const struct radv_graphics_state_key *gfx_state,
@@ -2563,38 +2662,24 @@ radv_graphics_shaders_compile(struct radv_device *device, struct vk_pipeline_cac
                               struct radv_shader **gs_copy_shader, struct radv_shader_binary **gs_copy_binary)
 {
    const struct radv_physical_device *pdev = radv_device_physical(device);
-   const struct radv_instance *instance = radv_physical_device_instance(pdev);
-   const bool nir_cache = instance->perftest_flags & RADV_PERFTEST_NIR_CACHE;
-   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
-      if (!stages[s].entrypoint)
-         continue;
 
-      int64_t stage_start = os_time_get_nano();
-
-      /* NIR might already have been imported from a library. */
-      if (!stages[s].nir) {
-         struct radv_spirv_to_nir_options options = {
-            .lower_view_index_to_zero = !gfx_state->has_multiview_view_index,
-            .fix_dual_src_mrt1_export =
-               gfx_state->ps.epilog.mrt0_is_dual_src && instance->drirc.dual_color_blend_by_location,
-            .lower_view_index_to_device_index = stages[s].key.view_index_from_device_index,
-         };
-         blake3_hash key;
-
-         if (nir_cache) {
-            radv_hash_graphics_spirv_to_nir(key, &stages[s], &options);
-            stages[s].nir = radv_pipeline_cache_lookup_nir(device, cache, s, key);
-         }
-         if (!stages[s].nir) {
-            stages[s].nir = radv_shader_spirv_to_nir(device, &stages[s], &options, is_internal);
-            if (nir_cache)
-               radv_pipeline_cache_insert_nir(device, cache, key, stages[s].nir);
-         }
-      }
+   struct radv_graphics_spirv_to_nir_ctx spirv_ctx = {
+      .device = device,
+      .cache = cache,
+      .stages = stages,
+      .gfx_state = gfx_state,
+      .is_internal = is_internal,
+   };
 
-      stages[s].feedback.duration += os_time_get_nano() - stage_start;
+   /* NIR might already have been imported from a library. */
+   for (unsigned s = 0; s < MESA_VULKAN_SHADER_STAGES; s++) {
+      if (stages[s].entrypoint && !stages[s].nir)
+         spirv_ctx.stages_to_translate[spirv_ctx.stage_count++] = s;
    }
 
+   /* Translating SPIR-V to NIR only touches the stage itself. */
+   radv_shader_compile_parallel(device, spirv_ctx.stage_count, radv_graphics_shader_spirv_to_nir, &spirv_ctx);
+
    if (retained_shaders) {
       radv_pipeline_retain_shaders(retained_shaders, stages);
    }
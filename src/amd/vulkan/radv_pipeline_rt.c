@@ -569,6 +569,89 @@ radv_ray_tracing_stage_is_always_inlined(struct radv_ray_tracing_stage *stage)
    return stage->stage == MESA_SHADER_ANY_HIT || stage->stage == MESA_SHADER_INTERSECTION;
 }
 
+struct radv_rt_compile_ctx {
+   struct radv_device *device;
+   struct vk_pipeline_cache *cache;
+   const VkRayTracingPipelineCreateInfoKHR *pCreateInfo;
+   const VkPipelineCreationFeedbackCreateInfo *creation_feedback;
+   const struct radv_shader_stage_key *stage_keys;
+   struct radv_pipeline_layout *pipeline_layout;
+   struct radv_ray_tracing_pipeline *pipeline;
+   struct radv_serialized_shader_arena_block *capture_replay_handles;
+   struct radv_shader_stage *stages;
+   VkResult *results;
+   bool skip_shaders_cache;
+   bool monolithic;
+   bool raygen_imported;
+};
+
+static void
+radv_rt_precompile_stage(void *data, unsigned idx)
+{
+   struct radv_rt_compile_ctx *ctx = data;
+   struct radv_ray_tracing_stage *rt_stage = &ctx->pipeline->stages[idx];
+
+   if (rt_stage->shader || rt_stage->nir)
+      return;
+
+   int64_t stage_start = os_time_get_nano();
+
+   struct radv_shader_stage *stage = &ctx->stages[idx];
+   gl_shader_stage s = vk_to_mesa_shader_stage(ctx->pCreateInfo->pStages[idx].stage);
+   radv_pipeline_stage_init(ctx->pipeline->base.base.create_flags, &ctx->pCreateInfo->pStages[idx],
+                            ctx->pipeline_layout, &ctx->stage_keys[s], stage);
+
+   /* precompile the shader */
+   stage->nir = radv_shader_spirv_to_nir(ctx->device, stage, NULL, false);
+
+   NIR_PASS(_, stage->nir, radv_nir_lower_hit_attrib_derefs);
+
+   rt_stage->info = radv_gather_ray_tracing_stage_info(stage->nir);
+
+   stage->feedback.duration = os_time_get_nano() - stage_start;
+}
+
+static void
+radv_rt_compile_stage(void *data, unsigned idx)
+{
+   struct radv_rt_compile_ctx *ctx = data;
+   struct radv_ray_tracing_stage *rt_stage = &ctx->pipeline->stages[idx];
+   int64_t stage_start = os_time_get_nano();
+   struct radv_shader_stage *stage = &ctx->stages[idx];
+
+   /* Cases in which we need to compile the shader (raygen/callable/chit/miss):
+    *    TODO: - monolithic: Extend the loop to cover imported stages and force compilation of imported raygen
+    *                        shaders since pipeline library shaders use separate compilation.
+    *    - separate:   Compile any recursive stage if wasn't compiled yet.
+    */
+   bool shader_needed = !radv_ray_tracing_stage_is_always_inlined(rt_stage) && !rt_stage->shader;
+   if (rt_stage->stage == MESA_SHADER_CLOSEST_HIT || rt_stage->stage == MESA_SHADER_MISS)
+      shader_needed &= !ctx->monolithic || ctx->raygen_imported;
+
+   if (shader_needed) {
+      uint32_t stack_size = 0;
+      struct radv_serialized_shader_arena_block *replay_block =
+         ctx->capture_replay_handles[idx].arena_va ? &ctx->capture_replay_handles[idx] : NULL;
+
+      bool monolithic_raygen = ctx->monolithic && stage->stage == MESA_SHADER_RAYGEN;
+
+      ctx->results[idx] = radv_rt_nir_to_asm(ctx->device, ctx->cache, ctx->pCreateInfo, ctx->pipeline,
+                                             monolithic_raygen, stage, &stack_size, &rt_stage->info, NULL,
+                                             replay_block, ctx->skip_shaders_cache, &rt_stage->shader);
+      if (ctx->results[idx] != VK_SUCCESS)
+         return;
+
+      assert(rt_stage->stack_size <= stack_size);
+      rt_stage->stack_size = stack_size;
+   }
+
+   if (ctx->creation_feedback && ctx->creation_feedback->pipelineStageCreationFeedbackCount) {
+      assert(idx < ctx->creation_feedback->pipelineStageCreationFeedbackCount);
+      stage->feedback.duration += os_time_get_nano() - stage_start;
+      ctx->creation_feedback->pPipelineStageCreationFeedbacks[idx] = stage->feedback;
+   }
+}
+
 static VkResult
 radv_rt_compile_shaders(struct radv_device *device, struct vk_pipeline_cache *cache,
                         const VkRayTracingPipelineCreateInfoKHR *pCreateInfo,
@@ -585,44 +668,46 @@ radv_rt_compile_shaders(struct radv_device *device, struct vk_pipeline_cache *ca
    struct radv_ray_tracing_stage *rt_stages = pipeline->stages;
 
    struct radv_shader_stage *stages = calloc(pCreateInfo->stageCount, sizeof(struct radv_shader_stage));
-   if (!stages)
+   VkResult *results = calloc(pCreateInfo->stageCount, sizeof(VkResult));
+   if (!stages || !results) {
+      free(stages);
+      free(results);
       return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
 
    bool library = pipeline->base.base.create_flags & VK_PIPELINE_CREATE_2_LIBRARY_BIT_KHR;
 
-   bool monolithic = !library;
-   for (uint32_t i = 0; i < pCreateInfo->stageCount; i++) {
-      if (rt_stages[i].shader || rt_stages[i].nir)
-         continue;
-
-      int64_t stage_start = os_time_get_nano();
-
-      struct radv_shader_stage *stage = &stages[i];
-      gl_shader_stage s = vk_to_mesa_shader_stage(pCreateInfo->pStages[i].stage);
-      radv_pipeline_stage_init(pipeline->base.base.create_flags, &pCreateInfo->pStages[i],
-                               pipeline_layout, &stage_keys[s], stage);
-
-      /* precompile the shader */
-      stage->nir = radv_shader_spirv_to_nir(device, stage, NULL, false);
-
-      NIR_PASS(_, stage->nir, radv_nir_lower_hit_attrib_derefs);
-
-      rt_stages[i].info = radv_gather_ray_tracing_stage_info(stage->nir);
+   struct radv_rt_compile_ctx ctx = {
+      .device = device,
+      .cache = cache,
+      .pCreateInfo = pCreateInfo,
+      .creation_feedback = creation_feedback,
+      .stage_keys = stage_keys,
+      .pipeline_layout = pipeline_layout,
+      .pipeline = pipeline,
+      .capture_replay_handles = capture_replay_handles,
+      .stages = stages,
+      .results = results,
+      .skip_shaders_cache = skip_shaders_cache,
+      .monolithic = !library,
+   };
 
-      stage->feedback.duration = os_time_get_nano() - stage_start;
-   }
+   /* Translating SPIR-V to NIR only touches the stage itself. */
+   radv_shader_compile_parallel(device, pCreateInfo->stageCount, radv_rt_precompile_stage, &ctx);
 
    bool has_callable = false;
    /* TODO: Recompile recursive raygen shaders instead. */
-   bool raygen_imported = false;
    for (uint32_t i = 0; i < pipeline->stage_count; i++) {
       has_callable |= rt_stages[i].stage == MESA_SHADER_CALLABLE;
-      monolithic &= rt_stages[i].info.can_inline;
+      ctx.monolithic &= rt_stages[i].info.can_inline;
 
       if (i >= pCreateInfo->stageCount)
-         raygen_imported |= rt_stages[i].stage == MESA_SHADER_RAYGEN;
+         ctx.raygen_imported |= rt_stages[i].stage == MESA_SHADER_RAYGEN;
    }
 
+   bool monolithic = ctx.monolithic;
+   bool raygen_imported = ctx.raygen_imported;
+
    for (uint32_t idx = 0; idx < pCreateInfo->stageCount; idx++) {
       if (rt_stages[idx].shader || rt_stages[idx].nir)
          continue;
@@ -652,40 +737,20 @@ radv_rt_compile_shaders(struct radv_device *device, struct vk_pipeline_cache *ca
       stage->feedback.duration += os_time_get_nano() - stage_start;
    }
 
-   for (uint32_t idx = 0; idx < pCreateInfo->stageCount; idx++) {
-      int64_t stage_start = os_time_get_nano();
-      struct radv_shader_stage *stage = &stages[idx];
-
-      /* Cases in which we need to compile the shader (raygen/callable/chit/miss):
-       *    TODO: - monolithic: Extend the loop to cover imported stages and force compilation of imported raygen
-       *                        shaders since pipeline library shaders use separate compilation.
-       *    - separate:   Compile any recursive stage if wasn't compiled yet.
-       */
-      bool shader_needed = !radv_ray_tracing_stage_is_always_inlined(&rt_stages[idx]) && !rt_stages[idx].shader;
-      if (rt_stages[idx].stage == MESA_SHADER_CLOSEST_HIT || rt_stages[idx].stage == MESA_SHADER_MISS)
-         shader_needed &= !monolithic || raygen_imported;
-
-      if (shader_needed) {
-         uint32_t stack_size = 0;
-         struct radv_serialized_shader_arena_block *replay_block =
-            capture_replay_handles[idx].arena_va ? &capture_replay_handles[idx] : NULL;
-
-         bool monolithic_raygen = monolithic && stage->stage == MESA_SHADER_RAYGEN;
-
-         result =
-            radv_rt_nir_to_asm(device, cache, pCreateInfo, pipeline, monolithic_raygen, stage, &stack_size,
-                               &rt_stages[idx].info, NULL, replay_block, skip_shaders_cache, &rt_stages[idx].shader);
-         if (result != VK_SUCCESS)
-            goto cleanup;
-
-         assert(rt_stages[idx].stack_size <= stack_size);
-         rt_stages[idx].stack_size = stack_size;
-      }
+   /* Separately compiled stages are independent of each other, but a monolithic raygen shader inlines the
+    * other stages, so keep compiling those in order.
+    */
+   if (monolithic) {
+      for (uint32_t idx = 0; idx < pCreateInfo->stageCount; idx++)
+         radv_rt_compile_stage(&ctx, idx);
+   } else {
+      radv_shader_compile_parallel(device, pCreateInfo->stageCount, radv_rt_compile_stage, &ctx);
+   }
 
-      if (creation_feedback && creation_feedback->pipelineStageCreationFeedbackCount) {
-         assert(idx < creation_feedback->pipelineStageCreationFeedbackCount);
-         stage->feedback.duration += os_time_get_nano() - stage_start;
-         creation_feedback->pPipelineStageCreationFeedbacks[idx] = stage->feedback;
+   for (uint32_t idx = 0; idx < pCreateInfo->stageCount; idx++) {
+      if (results[idx] != VK_SUCCESS) {
+         result = results[idx];
+         goto cleanup;
       }
    }
 
@@ -740,6 +805,7 @@ cleanup:
    for (uint32_t i = 0; i < pCreateInfo->stageCount; i++)
       ralloc_free(stages[i].nir);
    free(stages);
+   free(results);
    return result;
 }
 
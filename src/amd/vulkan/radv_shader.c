@@ -18,6 +18,7 @@
 #include "util/memstream.h"
 #include "util/mesa-sha1.h"
 #include "util/streaming-load-memcpy.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_atomic.h"
 #include "radv_cs.h"
 #include "radv_debug.h"
@@ -1335,6 +1336,98 @@ radv_destroy_shader_upload_queue(struct radv_device *device)
    }
 }
 
+static void
+radv_init_shader_compile_queue(const void *data)
+{
+   struct radv_device *device = (struct radv_device *)data;
+   const struct radv_physical_device *pdev = radv_device_physical(device);
+   const struct radv_instance *instance = radv_physical_device_instance(pdev);
+   const unsigned num_cpus = util_get_cpu_caps()->nr_cpus;
+
+   /* The LLVM backend isn't reentrant and dumping SPIR-V or shaders from multiple threads would interleave the
+    * output. ACO itself keeps no global state, it already has to cope with applications creating pipelines from
+    * several threads at once.
+    */
+   if (num_cpus < 2 || pdev->use_llvm ||
+       (instance->debug_flags & (RADV_DEBUG_NO_THREADED_COMPILE | RADV_DEBUG_DUMP_SPIRV | RADV_DEBUG_DUMP_SHADERS |
+                                 RADV_DEBUG_DUMP_SHADER_STATS)))
+      return;
+
+   /* The application thread participates in the compilation too. */
+   const unsigned num_threads = num_cpus - 1;
+
+   /* Compiling serially is always possible, so a failure isn't reported. */
+   if (!util_queue_init(&device->shader_compile_queue, "radv_sh", num_threads * 4, num_threads,
+                        UTIL_QUEUE_INIT_RESIZE_IF_FULL | UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY, NULL))
+      return;
+
+   device->shader_compile_queue_enabled = true;
+}
+
+void
+radv_destroy_shader_compile_queue(struct radv_device *device)
+{
+   if (!device->shader_compile_queue_enabled)
+      return;
+
+   util_queue_destroy(&device->shader_compile_queue);
+   device->shader_compile_queue_enabled = false;
+}
+
+struct radv_shader_compile_job {
+   struct util_queue_fence fence;
+   radv_shader_compile_func func;
+   void *data;
+   unsigned index;
+};
+
+static void
+radv_shader_compile_job_execute(void *job, void *gdata, int thread_index)
+{
+   struct radv_shader_compile_job *compile_job = job;
+
+   compile_job->func(compile_job->data, compile_job->index);
+}
+
+void
+radv_shader_compile_parallel(struct radv_device *device, unsigned count, radv_shader_compile_func func, void *data)
+{
+   struct radv_shader_compile_job *jobs = NULL;
+
+   /* Only devices that actually compile several shaders at once pay for the worker threads. */
+   if (count > 1)
+      util_call_once_data(&device->shader_compile_queue_once, radv_init_shader_compile_queue, device);
+
+   if (device->shader_compile_queue_enabled && count > 1)
+      jobs = calloc(count - 1, sizeof(*jobs));
+
+   if (!jobs) {
+      for (unsigned i = 0; i < count; i++)
+         func(data, i);
+      return;
+   }
+
+   /* Every job but the first goes to the worker threads, the first one is compiled on this thread while waiting. */
+   for (unsigned i = 1; i < count; i++) {
+      struct radv_shader_compile_job *job = &jobs[i - 1];
+
+      job->func = func;
+      job->data = data;
+      job->index = i;
+      util_queue_fence_init(&job->fence);
+      util_queue_add_job(&device->shader_compile_queue, job, &job->fence, radv_shader_compile_job_execute, NULL, 0);
+   }
+
+   func(data, 0);
+
+   for (unsigned i = 0; i < count - 1; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+
+   free(jobs);
+}
+
 static bool
 radv_should_use_wgp_mode(const struct radv_device *device, gl_shader_stage stage, const struct radv_shader_info *info)
 {
@@ -528,6 +528,15 @@ void radv_init_shader_arenas(struct radv_device *device);
 void radv_destroy_shader_arenas(struct radv_device *device);
 VkResult radv_init_shader_upload_queue(struct radv_device *device);
 void radv_destroy_shader_upload_queue(struct radv_device *device);
+void radv_destroy_shader_compile_queue(struct radv_device *device);
+
+typedef void (*radv_shader_compile_func)(void *data, unsigned index);
+
+/* Calls func(data, i) for every i in [0, count) and returns once all calls have finished. Calls may run
+ * concurrently on the device's shader compile queue, so they must only touch state owned by their index.
+ */
+void radv_shader_compile_parallel(struct radv_device *device, unsigned count, radv_shader_compile_func func,
+                                  void *data);
 
 struct radv_shader_args;
 
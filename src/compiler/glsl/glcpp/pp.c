@@ -254,3 +254,194 @@ glcpp_preprocess(void *ralloc_ctx, const char **shader, char **info_log,
 	glcpp_parser_destroy (parser);
 	return errors;
 }
+
+static bool
+is_ident_char(char c)
+{
+	return isalnum((unsigned char) c) || c == '_';
+}
+
+/* Skip a #version, #extension or #pragma directive that glcpp would pass
+ * through unchanged, returning a pointer to the end of the line, or NULL if
+ * the directive needs the full preprocessor.
+ */
+static const char *
+skip_passthrough_directive(const char *p, bool first_token)
+{
+	p++;
+	while (*p == ' ' || *p == '\t')
+		p++;
+
+	if (strncmp(p, "version", 7) == 0 && first_token) {
+		p += 7;
+		if (*p != ' ' && *p != '\t')
+			return NULL;
+		while (*p == ' ' || *p == '\t')
+			p++;
+
+		/* Octal and hexadecimal versions are errors. */
+		if (*p < '1' || *p > '9')
+			return NULL;
+		while (isdigit((unsigned char) *p))
+			p++;
+
+		if (*p == ' ' || *p == '\t') {
+			while (*p == ' ' || *p == '\t')
+				p++;
+			while (is_ident_char(*p))
+				p++;
+			while (*p == ' ' || *p == '\t')
+				p++;
+		}
+	} else if (strncmp(p, "extension", 9) == 0 ||
+		   strncmp(p, "pragma", 6) == 0) {
+		p += *p == 'e' ? 9 : 6;
+		if (*p != ' ' && *p != '\t')
+			return NULL;
+		while (*p == ' ' || *p == '\t')
+			p++;
+
+		/* Empty #pragma directives are swallowed by glcpp. */
+		if (*p == '\0' || *p == '\r' || *p == '\n')
+			return NULL;
+
+		while (*p != '\0' && *p != '\r' && *p != '\n') {
+			if (*p == '\\' ||
+			    (p[0] == '/' && (p[1] == '/' || p[1] == '*')))
+				return NULL;
+			p++;
+		}
+	} else {
+		return NULL;
+	}
+
+	if (*p == '\r')
+		p++;
+	if (*p != '\0' && *p != '\n')
+		return NULL;
+
+	return p;
+}
+
+/* Preprocess a shader that doesn't need glcpp.
+ *
+ * Most shaders contain no directives other than #version, #extension and
+ * #pragma, which glcpp passes through to the compiler, and don't refer to
+ * any predefined macro.  For those, preprocessing only strips comments, so
+ * do that in a single pass instead of building token lists for the whole
+ * source.  Newlines inside comments are moved after the comment, as glcpp
+ * does, so line numbers in compiler messages are unchanged.  Like glcpp, a
+ * newline is added at the end if the source doesn't end with one.  Unlike
+ * glcpp, whitespace and CR LF line endings are kept as they are, which the
+ * compiler doesn't care about.
+ *
+ * Returns false, leaving *shader untouched, if the shader contains
+ * anything else: other directives, line continuations, unterminated
+ * comments or identifiers that are (or might be) macros defined by glcpp.
+ */
+bool
+glcpp_preprocess_trivial(void *ralloc_ctx, const char **shader)
+{
+	const char *src = *shader;
+	char *out = ralloc_size(ralloc_ctx, strlen(src) + 2);
+	char *dst = out;
+	unsigned pending_newlines = 0;
+	bool line_start = true;
+	bool first_token = true;
+
+	while (*src) {
+		const char c = *src;
+
+		if (c == '\n' || (c == '\r' && src[1] == '\n')) {
+			if (c == '\r')
+				*dst++ = *src++;
+			*dst++ = *src++;
+			while (pending_newlines) {
+				*dst++ = '\n';
+				pending_newlines--;
+			}
+			line_start = true;
+		} else if (c == ' ' || c == '\t') {
+			*dst++ = *src++;
+		} else if (c == '/' && src[1] == '/') {
+			while (*src != '\0' && *src != '\r' && *src != '\n') {
+				if (*src == '\\')
+					goto fail;
+				src++;
+			}
+			line_start = false;
+		} else if (c == '/' && src[1] == '*') {
+			const char *end = strstr(src + 2, "*/");
+			if (end == NULL)
+				goto fail;
+
+			for (src += 2; src < end; src++) {
+				if (*src == '\\' ||
+				    (*src == '\r' && src[1] != '\n'))
+					goto fail;
+				if (*src == '\n')
+					pending_newlines++;
+			}
+			src += 2;
+			*dst++ = ' ';
+			line_start = false;
+		} else if (c == '#') {
+			const char *end;
+
+			if (!line_start)
+				goto fail;
+
+			end = skip_passthrough_directive(src, first_token);
+			if (end == NULL)
+				goto fail;
+
+			memcpy(dst, src, end - src);
+			dst += end - src;
+			src = end;
+			first_token = false;
+			line_start = false;
+		} else if (is_ident_char(c)) {
+			const char *start = src;
+			while (is_ident_char(*src))
+				src++;
+
+			/* Identifiers prefixed with "GL_" or containing "__"
+			 * are reserved for predefined macros.  Numbers are
+			 * checked too, since glcpp splits "1__LINE__" into
+			 * two tokens.
+			 */
+			for (const char *p = start; p < src; p++) {
+				if (p[0] == '_' && p[1] == '_' && p + 1 < src)
+					goto fail;
+				if (strncmp(p, "GL_", 3) == 0 && p + 2 < src)
+					goto fail;
+			}
+
+			memcpy(dst, start, src - start);
+			dst += src - start;
+			first_token = false;
+			line_start = false;
+		} else if (c == '\\' || c == '\r' || c == '\v' || c == '\f') {
+			goto fail;
+		} else {
+			*dst++ = *src++;
+			first_token = false;
+			line_start = false;
+		}
+	}
+
+	while (pending_newlines) {
+		*dst++ = '\n';
+		pending_newlines--;
+	}
+	if (dst > out && dst[-1] != '\n')
+		*dst++ = '\n';
+	*dst = '\0';
+
+	*shader = out;
+	return true;
+
+fail:
+	ralloc_free(out);
+	return false;
+}
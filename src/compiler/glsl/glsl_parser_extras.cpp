@@ -34,6 +34,7 @@
 #include "util/ralloc.h"
 #include "util/disk_cache.h"
 #include "util/mesa-blake3.h"
+#include "util/os_time.h"
 #include "ast.h"
 #include "glsl_parser_extras.h"
 #include "glsl_parser.h"
@@ -2295,7 +2296,7 @@ can_skip_compile(struct gl_context *ctx, struct gl_shader *shader,
                                 shader->disk_cache_sha1);
          if (disk_cache_has_key(ctx->Cache, shader->disk_cache_sha1)) {
             /* We've seen this shader before and know it compiles */
-            if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
+            if (ctx->Shader.Flags & GLSL_CACHE_INFO) {
                _mesa_sha1_format(buf, shader->disk_cache_sha1);
                fprintf(stderr, "deferring compile of shader: %s\n", buf);
             }
@@ -2334,7 +2335,7 @@ can_skip_compile(struct gl_context *ctx, struct gl_shader *shader,
 static void
 log_compile_skip(struct gl_context *ctx, struct gl_shader *shader)
 {
-   if (ctx->_Shader->Flags & GLSL_DUMP) {
+   if (ctx->Shader.Flags & GLSL_DUMP) {
       _mesa_log("No GLSL IR for shader %d (shader may be from cache)\n",
                 shader->Name);
    }
@@ -2382,8 +2383,25 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
                               false, true);
 
    if (!source_has_shader_include || !force_recompile) {
-      state->error = glcpp_preprocess(state, &source, &state->info_log,
-                                      add_builtin_defines, state, ctx);
+      const bool report_time = ctx->Shader.Flags & GLSL_PP_TIME;
+      const int64_t start = report_time ? os_time_get_nano() : 0;
+      const size_t source_len = report_time ? strlen(source) : 0;
+
+      /* Most shaders only need their comments stripped, which doesn't
+       * require running the full preprocessor.
+       */
+      const bool trivial = glcpp_preprocess_trivial(state, &source);
+      if (!trivial) {
+         state->error = glcpp_preprocess(state, &source, &state->info_log,
+                                         add_builtin_defines, state, ctx);
+      }
+
+      if (report_time) {
+         _mesa_log("GLSL preprocessor: shader %d, %zu bytes, %.3f ms%s\n",
+                   shader->Name, source_len,
+                   (os_time_get_nano() - start) / 1000000.0,
+                   trivial ? " (fast path)" : "");
+      }
    }
 
    /* Now that we have run the preprocessor we can check the shader cache and
@@ -2398,6 +2416,15 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    }
 
    if (!state->error) {
+     /* Nothing has been allocated from the AST arena yet.  Recreate it with
+      * buffers sized after the source, so large shaders don't need
+      * thousands of small buffers.
+      */
+     linear_opts lin_opts = {};
+     lin_opts.min_buffer_size = MIN2(4 * strlen(source), 1024 * 1024);
+     linear_free_context(state->linalloc);
+     state->linalloc = linear_context_with_opts(state, &lin_opts);
+
      _mesa_glsl_lexer_ctor(state, source);
      _mesa_glsl_parse(state);
      _mesa_glsl_lexer_dtor(state);
@@ -2433,6 +2460,14 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    if (!state->error)
       set_shader_inout_layout(shader, state);
 
+   /* The AST isn't needed once the HIR and the layout information have been
+    * generated.  Free it now instead of with the parse state, so it isn't
+    * kept around while the HIR is lowered and optimized.
+    */
+   state->translation_unit.make_empty();
+   linear_free_context(state->linalloc);
+   state->linalloc = NULL;
+
    shader->symbols = new(shader->ir) glsl_symbol_table;
    shader->CompileStatus = state->error ? COMPILE_FAILURE : COMPILE_SUCCESS;
    shader->InfoLog = state->info_log;
@@ -2474,7 +2509,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    delete state->symbols;
    ralloc_free(state);
 
-   if (ctx->_Shader && ctx->_Shader->Flags & GLSL_DUMP) {
+   if (ctx->Shader.Flags & GLSL_DUMP) {
       if (shader->CompileStatus) {
          assert(shader->ir);
          _mesa_log("GLSL IR for shader %d:\n", shader->Name);
@@ -2506,7 +2541,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    if (ctx->Cache && shader->CompileStatus == COMPILE_SUCCESS) {
       char sha1_buf[41];
       disk_cache_put_key(ctx->Cache, shader->disk_cache_sha1);
-      if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
+      if (ctx->Shader.Flags & GLSL_CACHE_INFO) {
          _mesa_sha1_format(sha1_buf, shader->disk_cache_sha1);
          fprintf(stderr, "marking shader: %s\n", sha1_buf);
       }
@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "util/ralloc.h"
+#include "main/mtypes.h"
+#include "glsl_parser_extras.h"
+
+class glcpp_trivial_test : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   /**
+    * Run the fast path on \c source, returning the output or NULL if the
+    * shader needs the full preprocessor.
+    */
+   const char *preprocess(const char *source);
+
+   /** Run the full preprocessor on \c source, like the glcpp binary. */
+   const char *glcpp(const char *source);
+
+   void *mem_ctx;
+   struct gl_context *gl_ctx;
+};
+
+/**
+ * Collapse runs of spaces and tabs, and turn CR LF into LF.  glcpp does
+ * both, but the fast path keeps the source's whitespace.
+ */
+static std::string
+normalize_whitespace(const char *s)
+{
+   std::string out;
+
+   while (*s) {
+      if (s[0] == '\r' && s[1] == '\n') {
+         s++;
+      } else if (*s == ' ' || *s == '\t') {
+         while (*s == ' ' || *s == '\t')
+            s++;
+         out += ' ';
+      } else {
+         out += *s++;
+      }
+   }
+
+   return out;
+}
+
+void
+glcpp_trivial_test::SetUp()
+{
+   mem_ctx = ralloc_context(NULL);
+
+   /* Same as the context the glcpp binary sets up. */
+   gl_ctx = rzalloc(mem_ctx, struct gl_context);
+   gl_ctx->API = API_OPENGL_COMPAT;
+}
+
+void
+glcpp_trivial_test::TearDown()
+{
+   ralloc_free(mem_ctx);
+   mem_ctx = NULL;
+   gl_ctx = NULL;
+}
+
+const char *
+glcpp_trivial_test::preprocess(const char *source)
+{
+   const char *shader = source;
+   if (!glcpp_preprocess_trivial(mem_ctx, &shader)) {
+      EXPECT_EQ(source, shader);
+      return NULL;
+   }
+
+   EXPECT_LE(strlen(shader), strlen(source) + 1);
+   return shader;
+}
+
+const char *
+glcpp_trivial_test::glcpp(const char *source)
+{
+   const char *shader = source;
+   char *info_log = ralloc_strdup(mem_ctx, "");
+
+   EXPECT_EQ(0, glcpp_preprocess(mem_ctx, &shader, &info_log, NULL, NULL,
+                                 gl_ctx));
+   EXPECT_STREQ("", info_log);
+   return shader;
+}
+
+TEST_F(glcpp_trivial_test, passes_through_directives)
+{
+   const char *src =
+      "#version 450 core\n"
+      "#extension GL_ARB_gpu_shader_int64 : enable\n"
+      "  #pragma optimize(off)\n"
+      "void main() {}\n";
+
+   EXPECT_STREQ(src, preprocess(src));
+   EXPECT_STREQ("#version 300 es\r\nvoid main() {}\r\n",
+                preprocess("#version 300 es\r\nvoid main() {}\r\n"));
+}
+
+TEST_F(glcpp_trivial_test, adds_final_newline)
+{
+   EXPECT_STREQ("void main() {}\n", preprocess("void main() {}"));
+   EXPECT_STREQ("int a; \n", preprocess("int a; // comment"));
+   EXPECT_STREQ("", preprocess(""));
+}
+
+TEST_F(glcpp_trivial_test, strips_comments)
+{
+   EXPECT_STREQ("#version 130\n"
+                "int a; \n"
+                "int b;    int c;\n"
+                "\n"
+                "\n",
+                preprocess("#version 130\n"
+                           "int a; // comment\n"
+                           "int b; /* multi\n"
+                           " * line */  int c;\n"
+                           "\n"));
+   EXPECT_STREQ("a b\n", preprocess("a/**/b"));
+}
+
+TEST_F(glcpp_trivial_test, falls_back)
+{
+   /* Directives glcpp handles itself. */
+   EXPECT_EQ(NULL, preprocess("#define FOO 1\nint a = FOO;\n"));
+   EXPECT_EQ(NULL, preprocess("#ifdef GL_ES\nprecision highp float;\n#endif\n"));
+   EXPECT_EQ(NULL, preprocess("#include \"foo.glsl\"\n"));
+   EXPECT_EQ(NULL, preprocess("#line 10\n"));
+   EXPECT_EQ(NULL, preprocess("#\n"));
+   EXPECT_EQ(NULL, preprocess("#pragma\n"));
+
+   /* #version that isn't first, or isn't a decimal constant. */
+   EXPECT_EQ(NULL, preprocess("int a;\n#version 130\n"));
+   EXPECT_EQ(NULL, preprocess("#version 0x82\n"));
+   EXPECT_EQ(NULL, preprocess("#version 130 // comment\n"));
+
+   /* Predefined macros. */
+   EXPECT_EQ(NULL, preprocess("int a = __LINE__;\n"));
+   EXPECT_EQ(NULL, preprocess("int a = __VERSION__;\n"));
+   EXPECT_EQ(NULL, preprocess("bool a = GL_ES;\n"));
+   EXPECT_EQ(NULL, preprocess("int a = 1__LINE__;\n"));
+
+   /* Line continuations, stray '#', old Mac newlines and unterminated
+    * comments.
+    */
+   EXPECT_EQ(NULL, preprocess("int a \\\n= 1;\n"));
+   EXPECT_EQ(NULL, preprocess("int a; #version 130\n"));
+   EXPECT_EQ(NULL, preprocess("int a;\rint b;\r"));
+   EXPECT_EQ(NULL, preprocess("int a; /* comment\n"));
+}
+
+/**
+ * Every glcpp test input the fast path accepts has to give the same output
+ * as glcpp, apart from whitespace within a line, with both Unix and DOS
+ * line endings.
+ */
+TEST_F(glcpp_trivial_test, matches_glcpp)
+{
+   const std::filesystem::path dir =
+      std::filesystem::path(GLCPP_TEST_SOURCE_DIR);
+   unsigned num_tests = 0, num_trivial = 0;
+
+   for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+      if (entry.path().extension() != ".c")
+         continue;
+
+      std::ifstream file(entry.path(), std::ios::binary);
+      std::stringstream contents;
+      contents << file.rdbuf();
+
+      const std::string unix_source = contents.str();
+      std::string dos_source;
+      for (char c : unix_source) {
+         if (c == '\n')
+            dos_source += '\r';
+         dos_source += c;
+      }
+
+      const std::string *sources[] = { &unix_source, &dos_source };
+      for (const std::string *source : sources) {
+         SCOPED_TRACE(entry.path().filename().string() +
+                      (source == &dos_source ? " (CR LF)" : ""));
+
+         num_tests++;
+         const char *trivial = preprocess(source->c_str());
+         if (trivial == NULL)
+            continue;
+
+         num_trivial++;
+         EXPECT_EQ(normalize_whitespace(glcpp(source->c_str())),
+                   normalize_whitespace(trivial));
+      }
+   }
+
+   EXPECT_GT(num_tests, 0u);
+   EXPECT_GT(num_trivial, 0u);
+}
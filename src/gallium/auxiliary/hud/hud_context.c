@@ -1321,6 +1321,15 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "API-thread-num-batches") == 0) {
          hud_thread_counter_install(pane, name, HUD_COUNTER_BATCHES);
       }
+      else if (strcmp(name, "API-thread-stall-us") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_STALL_TIME);
+      }
+      else if (strcmp(name, "API-thread-queue-depth") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_QUEUE_DEPTH);
+      }
+      else if (strcmp(name, "API-thread-batch-size-KB") == 0) {
+         hud_thread_counter_install(pane, name, HUD_COUNTER_BATCH_SIZE);
+      }
       else if (strcmp(name, "main-thread-busy") == 0) {
          hud_thread_busy_install(pane, name, true);
       }
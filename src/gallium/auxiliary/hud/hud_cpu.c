@@ -33,6 +33,7 @@
 #include "util/u_thread.h"
 #include "util/u_memory.h"
 #include "util/u_queue.h"
+#include "util/u_atomic.h"
 #include <stdio.h>
 #include <inttypes.h>
 #if DETECT_OS_WINDOWS
@@ -424,6 +425,12 @@ static unsigned get_counter(struct hud_graph *gr, enum hud_counter counter)
       value = mon->num_batches;
       mon->num_batches = 0;
       return value;
+   case HUD_COUNTER_STALL_TIME:
+      return p_atomic_xchg(&mon->stall_time_us, 0);
+   case HUD_COUNTER_QUEUE_DEPTH:
+      return p_atomic_xchg(&mon->max_queue_depth, 0);
+   case HUD_COUNTER_BATCH_SIZE:
+      return mon->batch_size / 1024;
    default:
       assert(0);
       return 0;
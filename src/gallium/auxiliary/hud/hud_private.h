@@ -40,6 +40,9 @@ enum hud_counter {
    HUD_COUNTER_DIRECT,
    HUD_COUNTER_SYNCS,
    HUD_COUNTER_BATCHES,
+   HUD_COUNTER_STALL_TIME,
+   HUD_COUNTER_QUEUE_DEPTH,
+   HUD_COUNTER_BATCH_SIZE,
 };
 
 struct hud_context {
@@ -589,6 +589,15 @@ struct iris_uncompiled_shader {
    /* Whether shader uses atomic operations. */
    bool uses_atomic_load_store;
 
+   /**
+    * SIMD width picked for the variants compiled so far, in the format of
+    * brw_simd_hint.  Protected by lock.
+    */
+   uint8_t simd_hint_width;
+   bool simd_hint_spilled;
+   uint8_t simd_hint_skipped;
+   bool simd_hint_loaded;
+
    /** Size (in bytes) of the kernel input data */
    unsigned kernel_input_size;
 
@@ -1374,6 +1383,13 @@ iris_disk_cache_retrieve(struct iris_screen *screen,
                          struct iris_compiled_shader *shader,
                          const void *prog_key,
                          uint32_t prog_key_size);
+struct brw_simd_hint;
+bool iris_disk_cache_load_simd_hint(struct disk_cache *cache,
+                                    const struct iris_uncompiled_shader *ish,
+                                    struct brw_simd_hint *hint);
+void iris_disk_cache_store_simd_hint(struct disk_cache *cache,
+                                     const struct iris_uncompiled_shader *ish,
+                                     const struct brw_simd_hint *hint);
 
 /* iris_program_cache.c */
 
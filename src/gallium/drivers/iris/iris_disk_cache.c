@@ -158,6 +158,72 @@ iris_disk_cache_store(struct disk_cache *cache,
 #endif
 }
 
+/**
+ * Compute the disk cache key of the SIMD selection hint, which is shared by
+ * all the variants of a shader.
+ */
+static void
+iris_disk_cache_compute_simd_hint_key(struct disk_cache *cache,
+                                      const struct iris_uncompiled_shader *ish,
+                                      cache_key cache_key)
+{
+   static const char suffix[] = "simd_hint";
+   uint8_t data[sizeof(ish->nir_sha1) + sizeof(suffix)];
+
+   memcpy(data, ish->nir_sha1, sizeof(ish->nir_sha1));
+   memcpy(data + sizeof(ish->nir_sha1), suffix, sizeof(suffix));
+
+   disk_cache_compute_key(cache, data, sizeof(data), cache_key);
+}
+
+/**
+ * Look up the SIMD width picked when an earlier variant of the shader was
+ * compiled, possibly by another run of the application.
+ */
+bool
+iris_disk_cache_load_simd_hint(struct disk_cache *cache,
+                               const struct iris_uncompiled_shader *ish,
+                               struct brw_simd_hint *hint)
+{
+#ifdef ENABLE_SHADER_CACHE
+   if (!cache)
+      return false;
+
+   cache_key cache_key;
+   iris_disk_cache_compute_simd_hint_key(cache, ish, cache_key);
+
+   size_t size;
+   void *buffer = disk_cache_get(cache, cache_key, &size);
+   if (!buffer)
+      return false;
+
+   const bool found = size == sizeof(*hint);
+   if (found)
+      memcpy(hint, buffer, sizeof(*hint));
+
+   free(buffer);
+   return found;
+#else
+   return false;
+#endif
+}
+
+void
+iris_disk_cache_store_simd_hint(struct disk_cache *cache,
+                                const struct iris_uncompiled_shader *ish,
+                                const struct brw_simd_hint *hint)
+{
+#ifdef ENABLE_SHADER_CACHE
+   if (!cache)
+      return;
+
+   cache_key cache_key;
+   iris_disk_cache_compute_simd_hint_key(cache, ish, cache_key);
+
+   disk_cache_put(cache, cache_key, hint, sizeof(*hint), NULL);
+#endif
+}
+
 static const enum iris_program_cache_id cache_id_for_stage[] = {
    [MESA_SHADER_VERTEX]    = IRIS_CACHE_VS,
    [MESA_SHADER_TESS_CTRL] = IRIS_CACHE_TCS,
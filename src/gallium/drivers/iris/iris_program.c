@@ -2600,6 +2600,57 @@ iris_update_compiled_gs(struct iris_context *ice)
    }
 }
 
+/**
+ * Get the SIMD width picked for earlier variants of the shader, so that
+ * new variants don't have to go through all the widths again.
+ */
+static struct brw_simd_hint
+iris_get_simd_hint(struct iris_screen *screen,
+                   struct iris_uncompiled_shader *ish)
+{
+   struct brw_simd_hint hint = { 0 };
+
+   simple_mtx_lock(&ish->lock);
+
+   if (!ish->simd_hint_loaded) {
+      if (iris_disk_cache_load_simd_hint(screen->disk_cache, ish, &hint)) {
+         ish->simd_hint_width = hint.dispatch_width;
+         ish->simd_hint_spilled = hint.spilled;
+      }
+      ish->simd_hint_loaded = true;
+   }
+
+   hint.dispatch_width = ish->simd_hint_width;
+   hint.spilled = ish->simd_hint_spilled;
+   hint.skipped = ish->simd_hint_skipped;
+
+   simple_mtx_unlock(&ish->lock);
+
+   return hint;
+}
+
+static void
+iris_update_simd_hint(struct iris_screen *screen,
+                      struct iris_uncompiled_shader *ish,
+                      const struct brw_simd_hint *hint)
+{
+   simple_mtx_lock(&ish->lock);
+
+   const bool changed = ish->simd_hint_width != hint->dispatch_width ||
+                        ish->simd_hint_spilled != hint->spilled;
+   ish->simd_hint_width = hint->dispatch_width;
+   ish->simd_hint_spilled = hint->spilled;
+   ish->simd_hint_skipped = hint->skipped;
+
+   simple_mtx_unlock(&ish->lock);
+
+   /* Otherwise only the count of compiles that skipped the wider widths
+    * changed, which isn't worth a disk cache write.
+    */
+   if (changed)
+      iris_disk_cache_store_simd_hint(screen->disk_cache, ish, hint);
+}
+
 /**
  * Compile a fragment (pixel) shader, and upload the assembly.
  */
@@ -2651,6 +2702,7 @@ iris_compile_fs(struct iris_screen *screen,
       brw_nir_analyze_ubo_ranges(screen->brw, nir, brw_prog_data->base.ubo_ranges);
 
       struct brw_wm_prog_key brw_key = iris_to_brw_fs_key(screen, key);
+      struct brw_simd_hint simd_hint = iris_get_simd_hint(screen, ish);
 
       struct brw_compile_fs_params params = {
          .base = {
@@ -2658,6 +2710,7 @@ iris_compile_fs(struct iris_screen *screen,
             .nir = nir,
             .log_data = dbg,
             .source_hash = ish->source_hash,
+            .simd_hint = &simd_hint,
          },
          .key = &brw_key,
          .prog_data = brw_prog_data,
@@ -2670,6 +2723,7 @@ iris_compile_fs(struct iris_screen *screen,
       program = brw_compile_fs(screen->brw, &params);
       error = params.base.error_str;
       if (program) {
+         iris_update_simd_hint(screen, ish, &simd_hint);
          iris_debug_recompile_brw(screen, dbg, ish, &brw_key.base);
          iris_apply_brw_prog_data(shader, &brw_prog_data->base);
       }
@@ -2974,6 +3028,7 @@ iris_compile_cs(struct iris_screen *screen,
 
    if (screen->brw) {
       struct brw_cs_prog_key brw_key = iris_to_brw_cs_key(screen, key);
+      struct brw_simd_hint simd_hint = iris_get_simd_hint(screen, ish);
 
       struct brw_cs_prog_data *brw_prog_data =
          rzalloc(mem_ctx, struct brw_cs_prog_data);
@@ -2984,6 +3039,7 @@ iris_compile_cs(struct iris_screen *screen,
             .nir = nir,
             .log_data = dbg,
             .source_hash = ish->source_hash,
+            .simd_hint = &simd_hint,
          },
          .key = &brw_key,
          .prog_data = brw_prog_data,
@@ -2992,6 +3048,7 @@ iris_compile_cs(struct iris_screen *screen,
       program = brw_compile_cs(screen->brw, &params);
       error = params.base.error_str;
       if (program) {
+         iris_update_simd_hint(screen, ish, &simd_hint);
          iris_debug_recompile_brw(screen, dbg, ish, &brw_key.base);
          iris_apply_brw_prog_data(shader, &brw_prog_data->base);
       }
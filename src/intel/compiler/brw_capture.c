@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ *
+ * Capture of the input of brw_compile_vs(), brw_compile_fs() and
+ * brw_compile_cs() calls, so that compile time and code quality can be
+ * measured offline on the exact shaders a driver compiled.
+ *
+ * A capture is a blob made of a small header, the program key, the program
+ * data as set up by the driver (with the push parameters that the pointer in
+ * it refers to), the fragment shader parameters, the SIMD width hint as it
+ * was before the compile and the serialized NIR.  It
+ * is only meant to be read back by the same build of the compiler.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "brw_private.h"
+#include "compiler/nir/nir_serialize.h"
+#include "util/blob.h"
+#include "util/mesa-sha1.h"
+#include "util/u_debug.h"
+
+#define CAPTURE_MAGIC 0x63777262 /* "brwc" */
+#define CAPTURE_VERSION 2
+
+DEBUG_GET_ONCE_OPTION(capture_path, "INTEL_SHADER_CAPTURE_PATH", NULL)
+
+static bool
+capture_supported_stage(gl_shader_stage stage)
+{
+   return stage == MESA_SHADER_VERTEX ||
+          stage == MESA_SHADER_FRAGMENT ||
+          stage == MESA_SHADER_COMPUTE;
+}
+
+void
+brw_capture_compile(const struct brw_compiler *compiler,
+                    gl_shader_stage stage,
+                    const struct brw_compile_params *params,
+                    const void *key,
+                    const struct brw_stage_prog_data *prog_data,
+                    const struct brw_compile_fs_params *fs_params)
+{
+   const char *path = debug_get_option_capture_path();
+   if (likely(path == NULL))
+      return;
+
+   assert(capture_supported_stage(stage));
+
+   /* Fragment shaders following a mesh shader depend on the mesh shader's
+    * output layout, which isn't captured.
+    */
+   if (fs_params && fs_params->mue_map)
+      return;
+
+   struct blob blob;
+   blob_init(&blob);
+
+   blob_write_uint32(&blob, CAPTURE_MAGIC);
+   blob_write_uint32(&blob, CAPTURE_VERSION);
+   blob_write_uint32(&blob, compiler->devinfo->pci_device_id);
+   blob_write_uint32(&blob, stage);
+   blob_write_uint8(&blob, compiler->extended_bindless_surface_offset);
+   blob_write_uint8(&blob, compiler->use_bindless_sampler_offset);
+   blob_write_uint32(&blob, compiler->spilling_rate);
+
+   blob_write_bytes(&blob, key, brw_prog_key_size(stage));
+
+   /* The only pointer in the program data set up by drivers is the list of
+    * push parameters, which is written right after it.
+    */
+   const size_t prog_data_size = brw_prog_data_size(stage);
+   union {
+      struct brw_stage_prog_data base;
+      struct brw_vs_prog_data vs;
+      struct brw_wm_prog_data wm;
+      struct brw_cs_prog_data cs;
+   } data;
+   assert(prog_data_size <= sizeof(data));
+   memcpy(&data, prog_data, prog_data_size);
+   data.base.param = NULL;
+   data.base.relocs = NULL;
+   data.base.printf_info = NULL;
+   data.base.printf_info_count = 0;
+   blob_write_bytes(&blob, &data, prog_data_size);
+   blob_write_bytes(&blob, prog_data->param,
+                    prog_data->nr_params * sizeof(uint32_t));
+
+   if (stage == MESA_SHADER_FRAGMENT) {
+      blob_write_uint8(&blob, fs_params->vue_map != NULL);
+      if (fs_params->vue_map) {
+         blob_write_bytes(&blob, fs_params->vue_map,
+                          sizeof(*fs_params->vue_map));
+      }
+      blob_write_uint8(&blob, fs_params->allow_spilling);
+      blob_write_uint8(&blob, fs_params->use_rep_send);
+      blob_write_uint8(&blob, fs_params->max_polygons);
+   }
+
+   blob_write_uint8(&blob, params->simd_hint != NULL);
+   if (params->simd_hint) {
+      blob_write_bytes(&blob, params->simd_hint,
+                       sizeof(*params->simd_hint));
+   }
+
+   nir_serialize(&blob, params->nir, false);
+
+   if (blob.out_of_memory) {
+      blob_finish(&blob);
+      return;
+   }
+
+   /* Name the file after its contents, so that compiling the same shader
+    * with the same key again doesn't add another capture.
+    */
+   unsigned char sha1[20];
+   char sha1_str[41];
+   _mesa_sha1_compute(blob.data, blob.size, sha1);
+   _mesa_sha1_format(sha1_str, sha1);
+
+   if (mkdir(path, 0777) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Failed to create capture directory %s\n", path);
+      blob_finish(&blob);
+      return;
+   }
+
+   char *filename = ralloc_asprintf(NULL, "%s/%s-%s.brwc", path,
+                                    _mesa_shader_stage_to_abbrev(stage),
+                                    sha1_str);
+   FILE *f = fopen(filename, "wb");
+   if (f) {
+      fwrite(blob.data, 1, blob.size, f);
+      fclose(f);
+   } else {
+      fprintf(stderr, "Failed to write shader capture %s\n", filename);
+   }
+
+   ralloc_free(filename);
+   blob_finish(&blob);
+}
+
+uint32_t
+brw_compile_capture_device_id(const void *data, size_t size)
+{
+   struct blob_reader blob;
+   blob_reader_init(&blob, data, size);
+
+   if (blob_read_uint32(&blob) != CAPTURE_MAGIC ||
+       blob_read_uint32(&blob) != CAPTURE_VERSION)
+      return 0;
+
+   const uint32_t pci_device_id = blob_read_uint32(&blob);
+   return blob.overrun ? 0 : pci_device_id;
+}
+
+bool
+brw_read_compile_capture(const struct brw_compiler *compiler, void *mem_ctx,
+                         const void *data, size_t size,
+                         struct brw_compile_capture *capture)
+{
+   struct blob_reader blob;
+   blob_reader_init(&blob, data, size);
+
+   memset(capture, 0, sizeof(*capture));
+
+   if (blob_read_uint32(&blob) != CAPTURE_MAGIC ||
+       blob_read_uint32(&blob) != CAPTURE_VERSION)
+      return false;
+
+   capture->pci_device_id = blob_read_uint32(&blob);
+   capture->stage = blob_read_uint32(&blob);
+   capture->extended_bindless_surface_offset = blob_read_uint8(&blob);
+   capture->use_bindless_sampler_offset = blob_read_uint8(&blob);
+   capture->spilling_rate = blob_read_uint32(&blob);
+   if (blob.overrun || !capture_supported_stage(capture->stage))
+      return false;
+
+   const gl_shader_stage stage = capture->stage;
+   blob_copy_bytes(&blob, &capture->key, brw_prog_key_size(stage));
+   blob_copy_bytes(&blob, &capture->prog_data, brw_prog_data_size(stage));
+   if (blob.overrun)
+      return false;
+
+   const unsigned nr_params = capture->prog_data.base.nr_params;
+   capture->prog_data.base.param =
+      ralloc_array(mem_ctx, uint32_t, nr_params);
+   blob_copy_bytes(&blob, capture->prog_data.base.param,
+                   nr_params * sizeof(uint32_t));
+
+   if (stage == MESA_SHADER_FRAGMENT) {
+      capture->has_vue_map = blob_read_uint8(&blob);
+      if (capture->has_vue_map) {
+         blob_copy_bytes(&blob, &capture->vue_map,
+                         sizeof(capture->vue_map));
+      }
+      capture->allow_spilling = blob_read_uint8(&blob);
+      capture->use_rep_send = blob_read_uint8(&blob);
+      capture->max_polygons = blob_read_uint8(&blob);
+   }
+
+   capture->has_simd_hint = blob_read_uint8(&blob);
+   if (capture->has_simd_hint) {
+      blob_copy_bytes(&blob, &capture->simd_hint,
+                      sizeof(capture->simd_hint));
+   }
+
+   if (blob.overrun)
+      return false;
+
+   capture->nir = nir_deserialize(mem_ctx, compiler->nir_options[stage],
+                                  &blob);
+
+   return capture->nir != NULL && !blob.overrun;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Assembles each input file without compaction and then times
+ * brw_compact_instructions() on the result.
+ *
+ *    find tests/gen12 -name "*.asm" | xargs brw_compact_bench -g tgl > a.csv
+ *
+ * The output is CSV, one line per file, so runs from two builds can be
+ * joined on the file name and compared.  The number of compacted
+ * instructions is included to make sure both builds compacted the same
+ * instructions.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/macros.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "compiler/brw_eu.h"
+#include "compiler/brw_inst.h"
+#include "dev/intel_device_info.h"
+
+#include "brw_asm.h"
+
+static void
+usage(const char *name)
+{
+   fprintf(stderr, "usage: %s -g PLATFORM [-r RUNS] FILE...\n", name);
+   exit(1);
+}
+
+static bool
+bench_file(const struct brw_isa_info *isa, const char *filename,
+           unsigned runs)
+{
+   const struct intel_device_info *devinfo = isa->devinfo;
+
+   FILE *f = fopen(filename, "r");
+   if (!f) {
+      fprintf(stderr, "%s: failed to open file\n", filename);
+      return false;
+   }
+
+   void *mem_ctx = ralloc_context(NULL);
+
+   brw_assemble_result r = brw_assemble(mem_ctx, devinfo, f, filename, 0);
+   fclose(f);
+
+   if (!r.bin) {
+      fprintf(stderr, "%s: failed to assemble\n", filename);
+      ralloc_free(mem_ctx);
+      return false;
+   }
+
+   /* brw_compact_instructions() rewrites the program in place, so every run
+    * starts from a fresh copy of the uncompacted instructions.
+    */
+   unsigned compacted = 0;
+   int64_t best = INT64_MAX, total = 0;
+   for (unsigned i = 0; i < runs; i++) {
+      struct brw_codegen *p = rzalloc(mem_ctx, struct brw_codegen);
+      brw_init_codegen(isa, p, p);
+
+      p->store_size = MAX2(p->store_size, r.inst_count);
+      p->store = reralloc(p, p->store, brw_inst, p->store_size);
+      memcpy(p->store, r.bin, r.bin_size);
+      p->next_insn_offset = r.bin_size;
+      p->nr_insn = r.inst_count;
+
+      int64_t start = os_time_get_nano();
+      brw_compact_instructions(p, 0, NULL);
+      int64_t elapsed = os_time_get_nano() - start;
+
+      best = MIN2(best, elapsed);
+      total += elapsed;
+
+      compacted = 0;
+      for (unsigned offset = 0; offset < p->next_insn_offset;) {
+         const brw_inst *inst = (const brw_inst *)((char *)p->store + offset);
+         if (brw_inst_cmpt_control(devinfo, inst)) {
+            compacted++;
+            offset += sizeof(brw_compact_inst);
+         } else {
+            offset += sizeof(brw_inst);
+         }
+      }
+
+      ralloc_free(p);
+   }
+
+   printf("%s,%d,%u,%" PRId64 ",%" PRId64 "\n",
+          filename, r.inst_count, compacted, best, total / runs);
+
+   ralloc_free(mem_ctx);
+
+   return true;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct intel_device_info devinfo;
+   bool have_devinfo = false;
+   unsigned runs = 10;
+   int i = 1;
+
+   for (; i < argc && argv[i][0] == '-'; i++) {
+      if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+         int n = atoi(argv[++i]);
+         runs = MAX2(n, 1);
+      } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+         const int id = intel_device_name_to_pci_device_id(argv[++i]);
+         if (id < 0 || !intel_get_device_info_from_pci_id(id, &devinfo)) {
+            fprintf(stderr, "can't find device information: %s\n", argv[i]);
+            return 1;
+         }
+         if (devinfo.ver < 9) {
+            fprintf(stderr, "device has gfx version %d but must be >= 9\n",
+                    devinfo.ver);
+            return 1;
+         }
+         have_devinfo = true;
+      } else {
+         usage(argv[0]);
+      }
+   }
+
+   if (!have_devinfo || i == argc)
+      usage(argv[0]);
+
+   struct brw_isa_info isa;
+   brw_init_isa_info(&isa, &devinfo);
+
+   printf("file,instructions,compacted,best_ns,mean_ns\n");
+
+   bool ok = true;
+   for (; i < argc; i++)
+      ok &= bench_file(&isa, argv[i], runs);
+
+   return ok ? 0 : 1;
+}
@@ -98,6 +98,132 @@ run_cs(fs_visitor &s, bool allow_spilling)
    return !s.failed;
 }
 
+static std::unique_ptr<fs_visitor>
+create_cs_variant(const struct brw_compiler *compiler,
+                  struct brw_compile_params *params,
+                  const struct brw_cs_prog_key *key,
+                  struct brw_cs_prog_data *prog_data,
+                  const nir_shader *nir, unsigned simd,
+                  bool debug_enabled)
+{
+   const unsigned dispatch_width = 8u << simd;
+
+   nir_shader *shader = nir_shader_clone(params->mem_ctx, nir);
+   brw_nir_apply_key(shader, compiler, &key->base,
+                     dispatch_width);
+
+   NIR_PASS(_, shader, brw_nir_lower_simd, dispatch_width);
+
+   /* Clean up after the local index and ID calculations. */
+   NIR_PASS(_, shader, nir_opt_constant_folding);
+   NIR_PASS(_, shader, nir_opt_dce);
+
+   brw_postprocess_nir(shader, compiler, debug_enabled,
+                       key->base.robust_flags);
+
+   return std::make_unique<fs_visitor>(compiler, params,
+                                       &key->base,
+                                       &prog_data->base,
+                                       shader, dispatch_width,
+                                       params->stats != NULL,
+                                       debug_enabled);
+}
+
+/**
+ * SIMD variants of a compute shader with a variable workgroup size, compiled
+ * concurrently.  All of them are compiled no matter what happens to the
+ * others and import their uniforms from the first variant, so each one can
+ * run on its own thread with a private memory context and prog_data.
+ */
+struct cs_parallel_variants {
+   const struct brw_compiler *compiler;
+   const struct brw_cs_prog_key *key;
+   const nir_shader *nir;
+   fs_visitor *import_from;
+   bool debug_enabled;
+
+   std::unique_ptr<fs_visitor> *v;
+   struct brw_compile_params params[SIMD_COUNT];
+   struct brw_cs_prog_data prog_data[SIMD_COUNT];
+   bool ok[SIMD_COUNT];
+
+   unsigned simd[SIMD_COUNT];
+   unsigned count;
+};
+
+static void
+compile_cs_variant_job(void *data, unsigned index)
+{
+   cs_parallel_variants *jobs = (cs_parallel_variants *) data;
+   const unsigned simd = jobs->simd[index];
+
+   jobs->v[simd] = create_cs_variant(jobs->compiler, &jobs->params[simd],
+                                     jobs->key, &jobs->prog_data[simd],
+                                     jobs->nir, simd, jobs->debug_enabled);
+   jobs->v[simd]->import_uniforms(jobs->import_from);
+
+   jobs->ok[simd] = run_cs(*jobs->v[simd], true /* allow_spilling */);
+}
+
+static void
+compile_cs_variants_parallel(const struct brw_compiler *compiler,
+                             struct brw_compile_cs_params *params,
+                             brw_simd_selection_state &simd_state,
+                             std::unique_ptr<fs_visitor> *v,
+                             unsigned first_simd, bool debug_enabled)
+{
+   struct brw_cs_prog_data *prog_data = params->prog_data;
+
+   cs_parallel_variants jobs = {};
+   jobs.compiler = compiler;
+   jobs.key = params->key;
+   jobs.nir = params->base.nir;
+   jobs.import_from = v[brw_simd_first_compiled(simd_state)].get();
+   jobs.debug_enabled = debug_enabled;
+   jobs.v = v;
+
+   /* With a variable workgroup size, whether a variant should be compiled
+    * doesn't depend on the variants compiled before it.
+    */
+   for (unsigned simd = first_simd; simd < SIMD_COUNT; simd++) {
+      if (simd != first_simd && !brw_simd_should_compile(simd_state, simd))
+         continue;
+
+      jobs.params[simd] = params->base;
+      jobs.params[simd].mem_ctx = ralloc_context(NULL);
+      jobs.prog_data[simd] = *prog_data;
+      jobs.simd[jobs.count++] = simd;
+   }
+
+   brw_simd_compile_parallel(compiler, jobs.count, compile_cs_variant_job,
+                             &jobs);
+
+   for (unsigned i = 0; i < jobs.count; i++) {
+      const unsigned simd = jobs.simd[i];
+
+      ralloc_steal(params->base.mem_ctx, jobs.params[simd].mem_ctx);
+      v[simd]->prog_data = &prog_data->base;
+
+      /* Everything else run_cs() writes to the prog_data was already
+       * written by the first variant.
+       */
+      prog_data->base.total_scratch =
+         MAX2(prog_data->base.total_scratch,
+              jobs.prog_data[simd].base.total_scratch);
+
+      if (jobs.ok[simd]) {
+         cs_fill_push_const_info(compiler->devinfo, prog_data);
+
+         brw_simd_mark_compiled(simd_state, simd, v[simd]->spilled_any_registers);
+      } else {
+         simd_state.error[simd] = ralloc_strdup(params->base.mem_ctx, v[simd]->fail_msg);
+         brw_shader_perf_log(compiler, params->base.log_data,
+                             "SIMD%u shader failed to compile: %s\n",
+                             8u << simd, v[simd]->fail_msg);
+      }
+   }
+}
+
 const unsigned *
 brw_compile_cs(const struct brw_compiler *compiler,
                struct brw_compile_cs_params *params)
@@ -110,6 +236,9 @@ brw_compile_cs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_CS);
 
+   brw_capture_compile(compiler, MESA_SHADER_COMPUTE, &params->base, key,
+                       &prog_data->base, NULL);
+
    prog_data->base.stage = MESA_SHADER_COMPUTE;
    prog_data->base.total_shared = nir->info.shared_size;
    prog_data->base.ray_queries = nir->info.ray_queries;
@@ -129,53 +258,51 @@ brw_compile_cs(const struct brw_compiler *compiler,
       .required_width = brw_required_dispatch_width(&nir->info),
    };
 
-   std::unique_ptr<fs_visitor> v[3];
-
-   for (unsigned simd = 0; simd < 3; simd++) {
-      if (!brw_simd_should_compile(simd_state, simd))
-         continue;
-
-      const unsigned dispatch_width = 8u << simd;
+   brw_simd_apply_hint(simd_state, params->base.simd_hint);
 
-      nir_shader *shader = nir_shader_clone(params->base.mem_ctx, nir);
-      brw_nir_apply_key(shader, compiler, &key->base,
-                        dispatch_width);
+   std::unique_ptr<fs_visitor> v[3];
 
-      NIR_PASS(_, shader, brw_nir_lower_simd, dispatch_width);
+   do {
+      for (unsigned simd = 0; simd < 3; simd++) {
+         if (!brw_simd_should_compile(simd_state, simd))
+            continue;
+
+         /* Once the first variant of a shader with a variable workgroup size
+          * is compiled, all the remaining ones can be compiled concurrently.
+          */
+         if (nir->info.workgroup_size_variable &&
+             brw_simd_any_compiled(simd_state) &&
+             brw_simd_use_threads(compiler, debug_enabled)) {
+            compile_cs_variants_parallel(compiler, params, simd_state, v, simd,
+                                         debug_enabled);
+            break;
+         }
 
-      /* Clean up after the local index and ID calculations. */
-      NIR_PASS(_, shader, nir_opt_constant_folding);
-      NIR_PASS(_, shader, nir_opt_dce);
+         const unsigned dispatch_width = 8u << simd;
 
-      brw_postprocess_nir(shader, compiler, debug_enabled,
-                          key->base.robust_flags);
+         v[simd] = create_cs_variant(compiler, &params->base, key, prog_data,
+                                     nir, simd, debug_enabled);
 
-      v[simd] = std::make_unique<fs_visitor>(compiler, &params->base,
-                                             &key->base,
-                                             &prog_data->base,
-                                             shader, dispatch_width,
-                                             params->base.stats != NULL,
-                                             debug_enabled);
+         const int first = brw_simd_first_compiled(simd_state);
+         if (first >= 0)
+            v[simd]->import_uniforms(v[first].get());
 
-      const int first = brw_simd_first_compiled(simd_state);
-      if (first >= 0)
-         v[simd]->import_uniforms(v[first].get());
+         const bool allow_spilling = first < 0 || nir->info.workgroup_size_variable;
 
-      const bool allow_spilling = first < 0 || nir->info.workgroup_size_variable;
+         if (run_cs(*v[simd], allow_spilling)) {
+            cs_fill_push_const_info(compiler->devinfo, prog_data);
 
-      if (run_cs(*v[simd], allow_spilling)) {
-         cs_fill_push_const_info(compiler->devinfo, prog_data);
-
-         brw_simd_mark_compiled(simd_state, simd, v[simd]->spilled_any_registers);
-      } else {
-         simd_state.error[simd] = ralloc_strdup(params->base.mem_ctx, v[simd]->fail_msg);
-         if (simd > 0) {
-            brw_shader_perf_log(compiler, params->base.log_data,
-                                "SIMD%u shader failed to compile: %s\n",
-                                dispatch_width, v[simd]->fail_msg);
+            brw_simd_mark_compiled(simd_state, simd, v[simd]->spilled_any_registers);
+         } else {
+            simd_state.error[simd] = ralloc_strdup(params->base.mem_ctx, v[simd]->fail_msg);
+            if (simd > 0) {
+               brw_shader_perf_log(compiler, params->base.log_data,
+                                   "SIMD%u shader failed to compile: %s\n",
+                                   dispatch_width, v[simd]->fail_msg);
+            }
          }
       }
-   }
+   } while (brw_simd_retry_without_hint(simd_state));
 
    const int selected_simd = brw_simd_select(simd_state);
    if (selected_simd < 0) {
@@ -190,6 +317,8 @@ brw_compile_cs(const struct brw_compiler *compiler,
 
    assert(selected_simd < 3);
 
+   brw_simd_record_hint(simd_state, selected_simd, params->base.simd_hint);
+
    if (!nir->info.workgroup_size_variable)
       prog_data->prog_mask = 1 << selected_simd;
 
@@ -1435,6 +1435,33 @@ brw_assign_urb_setup(fs_visitor &s)
    s.first_non_payload_grf += prog_data->num_per_primitive_inputs / 2 * s.max_polygons;
 }
 
+/**
+ * Returns the reason to give up on a SIMD32 variant before register
+ * allocation, or NULL if it might still beat the narrower variants.
+ */
+static const char *
+fs_simd32_early_out(const fs_visitor &s)
+{
+   if (s.dispatch_width != 32 || s.simd32_min_throughput <= 0)
+      return NULL;
+
+   /* Scheduling rarely brings the pressure down by more than a third, and
+    * SIMD32 isn't allowed to spill when a narrower variant exists.
+    */
+   if (s.pre_ra_pressure > BRW_MAX_GRF * reg_unit(s.devinfo) * 3 / 2)
+      return "SIMD32 register pressure too high";
+
+   /* On Xe2 the only narrower variant is SIMD16, and SIMD32 beats it often
+    * enough that the pessimism of the pre-RA estimate turns into frequent
+    * mispredictions.  Only trust the pressure check there.
+    */
+   if (s.devinfo->ver < 20 &&
+       s.pre_ra_throughput < 0.9f * s.simd32_min_throughput)
+      return "SIMD32 predicted inefficient";
+
+   return NULL;
+}
+
 static bool
 run_fs(fs_visitor &s, bool allow_spilling, bool do_rep_send)
 {
@@ -1506,6 +1533,23 @@ run_fs(fs_visitor &s, bool allow_spilling, bool do_rep_send)
       brw_fs_workaround_memory_fence_before_eot(s);
       brw_fs_workaround_emit_dummy_mov_instruction(s);
 
+      /* Only SIMD32 is given up on before RA, see fs_simd32_early_out(). */
+      if (s.dispatch_width == 32 && s.max_polygons == 1) {
+         s.pre_ra_throughput = performance(&s).throughput;
+         s.pre_ra_pressure = brw_compute_max_register_pressure(s);
+      }
+
+      if (const char *msg = fs_simd32_early_out(s)) {
+         /* With do32 the variant is compiled anyway and the verdict checked
+          * against the final estimate.
+          */
+         if (!INTEL_DEBUG(DEBUG_DO32)) {
+            s.fail("%s", msg);
+            return false;
+         }
+         s.simd32_early_out = msg;
+      }
+
       brw_allocate_registers(s, allow_spilling);
 
       brw_fs_workaround_source_arf_before_eot(s);
@@ -1514,6 +1558,143 @@ run_fs(fs_visitor &s, bool allow_spilling, bool do_rep_send)
    return !s.failed;
 }
 
+/**
+ * SIMD8 and SIMD16 variants of a fragment shader compiled concurrently.
+ *
+ * SIMD16 is compiled from scratch.  What it would otherwise import from the
+ * SIMD8 variant (the push constant locations and the reduced UBO push
+ * ranges) only depends on the NIR and the key, so the result is the same.
+ * SIMD8 is compiled on the calling thread against the real prog_data;
+ * SIMD16 gets its own memory context and copy of the prog_data so the
+ * threads don't share mutable state.
+ */
+struct fs_speculative_variants {
+   std::unique_ptr<fs_visitor> v[SIMD_COUNT];
+   struct brw_compile_params params[SIMD_COUNT];
+   struct brw_wm_prog_data prog_data[SIMD_COUNT];
+   bool allow_spilling[SIMD_COUNT];
+   bool do_rep_send[SIMD_COUNT];
+   bool ok[SIMD_COUNT];
+
+   /* SIMD of each job, the first one runs on the calling thread. */
+   unsigned simd[SIMD_COUNT];
+   unsigned count;
+};
+
+static void
+run_fs_speculative(void *data, unsigned index)
+{
+   fs_speculative_variants *spec = (fs_speculative_variants *) data;
+   const unsigned simd = spec->simd[index];
+
+   spec->ok[simd] = run_fs(*spec->v[simd], spec->allow_spilling[simd],
+                           spec->do_rep_send[simd]);
+}
+
+static void
+compile_fs_speculative(fs_speculative_variants &spec,
+                       const struct brw_compiler *compiler,
+                       struct brw_compile_fs_params *params,
+                       const nir_shader *nir,
+                       const bool allow_spilling[2],
+                       bool debug_enabled)
+{
+   for (unsigned simd = 0; simd < 2; simd++) {
+      struct brw_compile_params *base = &params->base;
+      struct brw_wm_prog_data *prog_data = params->prog_data;
+
+      if (spec.count > 0) {
+         spec.params[simd] = params->base;
+         spec.params[simd].mem_ctx = ralloc_context(NULL);
+         spec.prog_data[simd] = *params->prog_data;
+         base = &spec.params[simd];
+         prog_data = &spec.prog_data[simd];
+      }
+
+      spec.v[simd] = std::make_unique<fs_visitor>(compiler, base, params->key,
+                                                  prog_data, nir, 8u << simd, 1,
+                                                  params->base.stats != NULL,
+                                                  debug_enabled);
+      spec.allow_spilling[simd] = allow_spilling[simd];
+      spec.do_rep_send[simd] = simd == 1 && params->use_rep_send;
+      spec.simd[spec.count++] = simd;
+   }
+
+   brw_simd_compile_parallel(compiler, spec.count, run_fs_speculative, &spec);
+
+   /* Hand the variants' allocations over to the caller's context so they
+    * live exactly as long as if they had been compiled serially.
+    */
+   for (unsigned i = 1; i < spec.count; i++)
+      ralloc_steal(params->base.mem_ctx, spec.params[spec.simd[i]].mem_ctx);
+}
+
+/**
+ * Whether nothing in the shader or the key limits it to SIMD8, see
+ * brw_emit_fb_writes().  SIMD16 is then tried unless SIMD8 spills.
+ */
+static bool
+fs_simd16_allowed(const struct brw_wm_prog_key *key, const nir_shader *nir)
+{
+   if (nir->info.outputs_written & BITFIELD64_BIT(FRAG_RESULT_STENCIL))
+      return false;
+
+   /* Dual source blending. */
+   if (key->force_dual_color_blend)
+      return false;
+
+   nir_foreach_shader_out_variable(var, nir) {
+      if (var->data.index > 0)
+         return false;
+   }
+
+   return true;
+}
+
+/**
+ * Compiles a SIMD variant of the fragment shader, or picks up the result of
+ * compiling it ahead of time.
+ */
+static bool
+compile_fs_variant(std::unique_ptr<fs_visitor> &v,
+                   fs_speculative_variants &spec, unsigned simd,
+                   const struct brw_compiler *compiler,
+                   struct brw_compile_fs_params *params,
+                   const nir_shader *nir, fs_visitor *import_from,
+                   bool allow_spilling, bool do_rep_send,
+                   float simd32_min_throughput, bool debug_enabled)
+{
+   struct brw_wm_prog_data *prog_data = params->prog_data;
+
+   if (spec.v[simd]) {
+      assert(spec.allow_spilling[simd] == allow_spilling);
+      assert(spec.do_rep_send[simd] == do_rep_send);
+
+      v = std::move(spec.v[simd]);
+
+      /* Everything else run_fs() writes to the prog_data is the same for
+       * all the variants and was already written by the first one.
+       */
+      if (v->prog_data != &prog_data->base) {
+         prog_data->base.total_scratch =
+            MAX2(prog_data->base.total_scratch,
+                 spec.prog_data[simd].base.total_scratch);
+         v->prog_data = &prog_data->base;
+      }
+      return spec.ok[simd];
+   }
+
+   v = std::make_unique<fs_visitor>(compiler, &params->base, params->key,
+                                    prog_data, nir, 8u << simd, 1,
+                                    params->base.stats != NULL,
+                                    debug_enabled);
+   if (import_from)
+      v->import_uniforms(import_from);
+   v->simd32_min_throughput = simd32_min_throughput;
+
+   return run_fs(*v, allow_spilling, do_rep_send);
+}
+
 const unsigned *
 brw_compile_fs(const struct brw_compiler *compiler,
                struct brw_compile_fs_params *params)
@@ -1526,6 +1707,9 @@ brw_compile_fs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_WM);
 
+   brw_capture_compile(compiler, MESA_SHADER_FRAGMENT, &params->base, key,
+                       &prog_data->base, params);
+
    prog_data->base.stage = MESA_SHADER_FRAGMENT;
    prog_data->base.ray_queries = nir->info.ray_queries;
    prog_data->base.total_scratch = 0;
@@ -1557,6 +1741,38 @@ brw_compile_fs(const struct brw_compiler *compiler,
    brw_nir_populate_wm_prog_data(nir, compiler->devinfo, key, prog_data,
                                  params->mue_map);
 
+   /* Don't try again the widths that lost when another variant of this
+    * shader was compiled.  The narrowest width is always compiled, so
+    * there's nothing to fall back to if the hinted width fails now.
+    */
+   struct brw_simd_hint *hint = params->base.simd_hint;
+   const unsigned hint_width =
+      brw_simd_hint_usable(hint) && !params->use_rep_send &&
+      !INTEL_DEBUG(DEBUG_DO32) ? hint->dispatch_width : 32;
+   const bool simd16_enabled =
+      (INTEL_SIMD(FS, 16) && (hint_width >= 16 || devinfo->ver >= 20)) ||
+      params->use_rep_send;
+   const bool simd32_enabled = INTEL_SIMD(FS, 32) && hint_width >= 32;
+
+   /* Unless SIMD8 spills, SIMD16 is kept whenever the shader allows it, so
+    * compile both concurrently up front; the logic below still decides
+    * which ones to keep exactly as if they were compiled one after another.
+    * SIMD32 is only worth compiling depending on how the narrower variants
+    * turned out, so it's never compiled ahead of time.
+    */
+   fs_speculative_variants spec = {};
+   if (devinfo->ver < 20 && simd16_enabled &&
+       fs_simd16_allowed(key, nir) &&
+       brw_simd_use_threads(compiler, debug_enabled)) {
+      /* Only the first variant that gets compiled is allowed to spill. */
+      const bool simd_allow_spilling[2] = {
+         allow_spilling,
+         allow_spilling && !INTEL_SIMD(FS, 8),
+      };
+      compile_fs_speculative(spec, compiler, params, nir, simd_allow_spilling,
+                             debug_enabled);
+   }
+
    std::unique_ptr<fs_visitor> v8, v16, v32, vmulti;
    cfg_t *simd8_cfg = NULL, *simd16_cfg = NULL, *simd32_cfg = NULL,
       *multi_cfg = NULL;
@@ -1564,11 +1780,9 @@ brw_compile_fs(const struct brw_compiler *compiler,
    bool has_spilled = false;
 
    if (devinfo->ver < 20) {
-      v8 = std::make_unique<fs_visitor>(compiler, &params->base, key,
-                                        prog_data, nir, 8, 1,
-                                        params->base.stats != NULL,
-                                        debug_enabled);
-      if (!run_fs(*v8, allow_spilling, false /* do_rep_send */)) {
+      if (!compile_fs_variant(v8, spec, 0, compiler, params, nir, NULL,
+                              allow_spilling, false /* do_rep_send */,
+                              0, debug_enabled)) {
          params->base.error_str = ralloc_strdup(params->base.mem_ctx,
                                                 v8->fail_msg);
          return NULL;
@@ -1596,15 +1810,11 @@ brw_compile_fs(const struct brw_compiler *compiler,
 
    if (!has_spilled &&
        (!v8 || v8->max_dispatch_width >= 16) &&
-       (INTEL_SIMD(FS, 16) || params->use_rep_send)) {
+       simd16_enabled) {
       /* Try a SIMD16 compile */
-      v16 = std::make_unique<fs_visitor>(compiler, &params->base, key,
-                                         prog_data, nir, 16, 1,
-                                         params->base.stats != NULL,
-                                         debug_enabled);
-      if (v8)
-         v16->import_uniforms(v8.get());
-      if (!run_fs(*v16, allow_spilling, params->use_rep_send)) {
+      if (!compile_fs_variant(v16, spec, 1, compiler, params, nir, v8.get(),
+                              allow_spilling, params->use_rep_send,
+                              0, debug_enabled)) {
          brw_shader_perf_log(compiler, params->base.log_data,
                              "SIMD16 shader failed to compile: %s\n",
                              v16->fail_msg);
@@ -1628,27 +1838,45 @@ brw_compile_fs(const struct brw_compiler *compiler,
        (!v8 || v8->max_dispatch_width >= 32) &&
        (!v16 || v16->max_dispatch_width >= 32) && !params->use_rep_send &&
        !simd16_failed &&
-       INTEL_SIMD(FS, 32)) {
-      /* Try a SIMD32 compile */
-      v32 = std::make_unique<fs_visitor>(compiler, &params->base, key,
-                                         prog_data, nir, 32, 1,
-                                         params->base.stats != NULL,
-                                         debug_enabled);
-      if (v8)
-         v32->import_uniforms(v8.get());
-      else if (v16)
-         v32->import_uniforms(v16.get());
-
-      if (!run_fs(*v32, allow_spilling, false)) {
+       simd32_enabled) {
+      /* Try a SIMD32 compile, unless the pre-RA estimates say it's going
+       * to lose against the narrower variants anyway.
+       */
+      if (!compile_fs_variant(v32, spec, 2, compiler, params, nir,
+                              v8 ? v8.get() : v16.get(), allow_spilling,
+                              false, throughput, debug_enabled)) {
          brw_shader_perf_log(compiler, params->base.log_data,
                              "SIMD32 shader failed to compile: %s\n",
                              v32->fail_msg);
       } else {
          const performance &perf = v32->performance_analysis.require();
 
+         if (INTEL_DEBUG(DEBUG_DO32) && throughput > 0) {
+            const bool simd32_won = perf.throughput > throughput;
+
+            if (v32->simd32_early_out && simd32_won) {
+               brw_shader_perf_log(compiler, params->base.log_data,
+                                   "SIMD32 early-out mispredicted: %s, but "
+                                   "%g vs %g after RA\n",
+                                   v32->simd32_early_out, perf.throughput,
+                                   throughput);
+            } else if (!v32->simd32_early_out && !simd32_won) {
+               brw_shader_perf_log(compiler, params->base.log_data,
+                                   "SIMD32 early-out missed: "
+                                   "pre-RA %g, pressure %u, "
+                                   "%g vs %g after RA\n",
+                                   v32->pre_ra_throughput,
+                                   v32->pre_ra_pressure, perf.throughput,
+                                   throughput);
+            }
+         }
+
          if (!INTEL_DEBUG(DEBUG_DO32) && throughput >= perf.throughput) {
             brw_shader_perf_log(compiler, params->base.log_data,
-                                "SIMD32 shader inefficient\n");
+                                "SIMD32 shader inefficient: "
+                                "pre-RA %g vs %g, pressure %u\n",
+                                v32->pre_ra_throughput, throughput,
+                                v32->pre_ra_pressure);
          } else {
             simd32_cfg = v32->cfg;
 
@@ -1730,6 +1958,15 @@ brw_compile_fs(const struct brw_compiler *compiler,
       }
    }
 
+   if (!params->use_rep_send) {
+      /* The wider widths lost if they were compiled, or if a narrower one
+       * spilled or failed.  Otherwise the key or the hint ruled them out.
+       */
+      brw_simd_update_hint(hint, hint_width < 32,
+                           simd32_cfg ? 32 : simd16_cfg ? 16 : 8,
+                           has_spilled, v32 || has_spilled || simd16_failed);
+   }
+
    /* When the caller requests a repclear shader, they want SIMD16-only */
    if (params->use_rep_send)
       simd8_cfg = NULL;
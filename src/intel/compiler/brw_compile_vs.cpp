@@ -72,6 +72,9 @@ brw_compile_vs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_VS);
 
+   brw_capture_compile(compiler, MESA_SHADER_VERTEX, &params->base, key,
+                       &prog_data->base.base, NULL);
+
    prog_data->base.base.stage = MESA_SHADER_VERTEX;
    prog_data->base.base.ray_queries = nir->info.ray_queries;
    prog_data->base.base.total_scratch = 0;
@@ -94,6 +94,8 @@ brw_compiler_create(void *mem_ctx, const struct intel_device_info *devinfo)
 
    brw_fs_alloc_reg_sets(compiler);
 
+   brw_simd_threads_init(compiler);
+
    compiler->precise_trig = debug_get_bool_option("INTEL_PRECISE_TRIG", false);
 
    compiler->use_tcs_multi_patch = devinfo->ver >= 12;
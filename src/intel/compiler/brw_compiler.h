@@ -44,6 +44,7 @@ extern "C" {
 struct ra_regs;
 struct nir_shader;
 struct shader_info;
+struct brw_simd_threads;
 
 struct nir_shader_compiler_options;
 typedef struct nir_shader nir_shader;
@@ -128,6 +129,13 @@ struct brw_compiler {
       unsigned mue_header_packing;
       bool mue_compaction;
    } mesh;
+
+   /**
+    * Worker threads compiling SIMD variants of a shader concurrently.  They
+    * are started the first time they are needed, and stopped when the
+    * compiler is freed.
+    */
+   struct brw_simd_threads *simd_threads;
 };
 
 #define brw_shader_debug_log(compiler, data, fmt, ... ) do {    \
@@ -1359,6 +1367,30 @@ brw_prog_data_size(gl_shader_stage stage);
 unsigned
 brw_prog_key_size(gl_shader_stage stage);
 
+/**
+ * Outcome of the SIMD width selection for one compile of a shader.
+ *
+ * Drivers creating several variants of the same shader (with different
+ * program keys) can keep this around, e.g. in their disk cache keyed by the
+ * NIR hash, and pass it back for the next variant.  The compiler then skips
+ * the widths that lost last time, and goes back to exploring all of them if
+ * the width that won before doesn't work with the new key.
+ *
+ * The hint is only narrowed when the wider widths were tried and lost, not
+ * when the key of a variant ruled them out, and all the widths are tried
+ * again every few compiles in case a wider one wins for the newer keys.
+ */
+struct brw_simd_hint {
+   /** Widest dispatch width that was picked, 0 if there's no hint. */
+   uint8_t dispatch_width;
+
+   /** Whether that variant had to spill. */
+   bool spilled;
+
+   /** Compiles that skipped the wider widths since they were last tried. */
+   uint8_t skipped;
+};
+
 struct brw_compile_params {
    void *mem_ctx;
 
@@ -1373,6 +1405,24 @@ struct brw_compile_params {
    uint64_t debug_flag;
 
    uint32_t source_hash;
+
+   /**
+    * Optional callback reporting how long each backend optimization pass and
+    * compilation phase took, for compile time benchmarks.  It is called with
+    * \p log_data once for every pass run, so passes running more than once
+    * per compile are reported more than once.  SIMD variants may be compiled
+    * on separate threads, which call it concurrently.
+    */
+   void (*report_pass_time)(void *log_data, gl_shader_stage stage,
+                            unsigned dispatch_width, const char *pass,
+                            uint64_t duration_ns);
+
+   /**
+    * Optional SIMD selection hint, only used for fragment and compute
+    * shaders.  Read before compiling, and updated with the outcome of this
+    * compile on success.
+    */
+   struct brw_simd_hint *simd_hint;
 };
 
 /**
@@ -1532,6 +1582,72 @@ const unsigned *
 brw_compile_cs(const struct brw_compiler *compiler,
                struct brw_compile_cs_params *params);
 
+/**
+ * Input of one brw_compile_vs(), brw_compile_fs() or brw_compile_cs() call.
+ *
+ * When the INTEL_SHADER_CAPTURE_PATH environment variable is set, those
+ * functions write their input to a file in that directory before compiling,
+ * whichever driver they are called from.  intel_compile_bench reads the files
+ * back with brw_read_compile_capture() to compile the same shaders again
+ * without the driver.
+ */
+struct brw_compile_capture {
+   gl_shader_stage stage;
+
+   /** Device the shader was compiled for. */
+   uint32_t pci_device_id;
+
+   /** Driver specific brw_compiler settings the shader was compiled with. */
+   bool extended_bindless_surface_offset;
+   bool use_bindless_sampler_offset;
+   int spilling_rate;
+
+   nir_shader *nir;
+
+   union {
+      struct brw_base_prog_key base;
+      struct brw_vs_prog_key vs;
+      struct brw_wm_prog_key wm;
+      struct brw_cs_prog_key cs;
+   } key;
+
+   /** Program data as set up by the driver before compiling. */
+   union {
+      struct brw_stage_prog_data base;
+      struct brw_vs_prog_data vs;
+      struct brw_wm_prog_data wm;
+      struct brw_cs_prog_data cs;
+   } prog_data;
+
+   /** Fragment shader parameters, see brw_compile_fs_params. */
+   bool has_vue_map;
+   struct intel_vue_map vue_map;
+   bool allow_spilling;
+   bool use_rep_send;
+   uint8_t max_polygons;
+
+   /** SIMD width hint the driver passed, as it was before the compile. */
+   bool has_simd_hint;
+   struct brw_simd_hint simd_hint;
+};
+
+/**
+ * Return the PCI device ID a capture was taken for, or 0 if \p data isn't a
+ * capture.
+ */
+uint32_t
+brw_compile_capture_device_id(const void *data, size_t size);
+
+/**
+ * Decode a capture written by a previous compile.  The NIR shader is
+ * allocated out of \p mem_ctx.  Returns false if \p data isn't a valid
+ * capture for \p compiler.
+ */
+bool
+brw_read_compile_capture(const struct brw_compiler *compiler, void *mem_ctx,
+                         const void *data, size_t size,
+                         struct brw_compile_capture *capture);
+
 /**
  * Parameters for compiling a Bindless shader.
  *
@@ -82,6 +82,7 @@
 #include "brw_disasm.h"
 #include "brw_disasm_info.h"
 #include "dev/intel_debug.h"
+#include "util/u_call_once.h"
 
 static const uint16_t g45_subreg_table[32] = {
    0b000000000000000,
@@ -912,6 +913,110 @@ static const uint32_t xe2_3src_subreg_table[32] = {
    0b00000000001111000000, /* .0 .60 .0 .0  */
 };
 
+/* Hash tables mapping the uncompacted bits back to the index of a
+ * compaction table entry, so that compacting an instruction doesn't need to
+ * scan every table.  They are built the first time a table is used.
+ */
+#define COMPACT_LOOKUP_BITS 7
+#define COMPACT_LOOKUP_SIZE (1 << COMPACT_LOOKUP_BITS)
+
+struct compact_table_lookup {
+   util_once_flag once;
+   const void *table;
+   uint8_t entry_size;
+   uint8_t len;
+
+   int8_t index[COMPACT_LOOKUP_SIZE]; /* -1 for empty slots */
+   uint64_t key[COMPACT_LOOKUP_SIZE];
+};
+
+static_assert(COMPACT_LOOKUP_SIZE >= 4 * 32,
+              "Lookup tables should stay sparse");
+
+#define COMPACT_TABLE_LOOKUP(name)                                      \
+   static struct compact_table_lookup name##_lookup = {                 \
+      .once = UTIL_ONCE_FLAG_INIT,                                      \
+      .table = name,                                                    \
+      .entry_size = sizeof(name[0]),                                    \
+      .len = ARRAY_SIZE(name),                                          \
+   }
+
+COMPACT_TABLE_LOOKUP(gfx8_control_index_table);
+COMPACT_TABLE_LOOKUP(gfx8_datatype_table);
+COMPACT_TABLE_LOOKUP(gfx8_subreg_table);
+COMPACT_TABLE_LOOKUP(gfx8_src_index_table);
+COMPACT_TABLE_LOOKUP(gfx11_datatype_table);
+COMPACT_TABLE_LOOKUP(gfx12_control_index_table);
+COMPACT_TABLE_LOOKUP(gfx12_datatype_table);
+COMPACT_TABLE_LOOKUP(gfx12_subreg_table);
+COMPACT_TABLE_LOOKUP(gfx12_src0_index_table);
+COMPACT_TABLE_LOOKUP(gfx12_src1_index_table);
+COMPACT_TABLE_LOOKUP(xehp_src0_index_table);
+COMPACT_TABLE_LOOKUP(xehp_src1_index_table);
+COMPACT_TABLE_LOOKUP(xe2_control_index_table);
+COMPACT_TABLE_LOOKUP(xe2_datatype_table);
+COMPACT_TABLE_LOOKUP(xe2_subreg_table);
+COMPACT_TABLE_LOOKUP(xe2_src0_index_table);
+COMPACT_TABLE_LOOKUP(xe2_src1_index_table);
+COMPACT_TABLE_LOOKUP(gfx8_3src_control_index_table);
+COMPACT_TABLE_LOOKUP(gfx8_3src_source_index_table);
+COMPACT_TABLE_LOOKUP(gfx12_3src_control_index_table);
+COMPACT_TABLE_LOOKUP(xehp_3src_control_index_table);
+COMPACT_TABLE_LOOKUP(xe2_3src_control_index_table);
+COMPACT_TABLE_LOOKUP(xe2_3src_dpas_control_index_table);
+COMPACT_TABLE_LOOKUP(gfx12_3src_source_index_table);
+COMPACT_TABLE_LOOKUP(xehp_3src_source_index_table);
+COMPACT_TABLE_LOOKUP(xe2_3src_source_index_table);
+COMPACT_TABLE_LOOKUP(xe2_3src_dpas_source_index_table);
+COMPACT_TABLE_LOOKUP(gfx12_3src_subreg_table);
+COMPACT_TABLE_LOOKUP(xe2_3src_subreg_table);
+
+static inline unsigned
+compact_lookup_hash(uint64_t key)
+{
+   return (key * 0x9e3779b97f4a7c15ull) >> (64 - COMPACT_LOOKUP_BITS);
+}
+
+static void
+compact_table_lookup_init(const void *data)
+{
+   struct compact_table_lookup *l = (struct compact_table_lookup *)data;
+
+   memset(l->index, -1, sizeof(l->index));
+
+   for (unsigned i = 0; i < l->len; i++) {
+      const uint64_t key =
+         l->entry_size == 2 ? ((const uint16_t *)l->table)[i] :
+         l->entry_size == 4 ? ((const uint32_t *)l->table)[i] :
+                              ((const uint64_t *)l->table)[i];
+
+      unsigned h = compact_lookup_hash(key);
+      while (l->index[h] >= 0 && l->key[h] != key)
+         h = (h + 1) % COMPACT_LOOKUP_SIZE;
+
+      /* Keep the first of duplicated entries, like a linear search would. */
+      if (l->index[h] < 0) {
+         l->index[h] = i;
+         l->key[h] = key;
+      }
+   }
+}
+
+/**
+ * Returns the index of the table entry equal to key, or -1.
+ */
+static int
+compact_table_find(struct compact_table_lookup *l, uint64_t key)
+{
+   util_call_once_data(&l->once, compact_table_lookup_init, l);
+
+   for (unsigned h = compact_lookup_hash(key);;
+        h = (h + 1) % COMPACT_LOOKUP_SIZE) {
+      if (l->index[h] < 0 || l->key[h] == key)
+         return l->index[h];
+   }
+}
+
 struct compaction_state {
    const struct brw_isa_info *isa;
    const uint32_t *control_index_table;
@@ -919,6 +1024,12 @@ struct compaction_state {
    const uint16_t *subreg_table;
    const uint16_t *src0_index_table;
    const uint16_t *src1_index_table;
+
+   struct compact_table_lookup *control_index_lookup;
+   struct compact_table_lookup *datatype_lookup;
+   struct compact_table_lookup *subreg_lookup;
+   struct compact_table_lookup *src0_index_lookup;
+   struct compact_table_lookup *src1_index_lookup;
 };
 
 static void compaction_state_init(struct compaction_state *c,
@@ -960,14 +1071,13 @@ set_control_index(const struct compaction_state *c,
                     (brw_inst_bits(src,  8,  8));        /*  1b */
    }
 
-   for (int i = 0; i < 32; i++) {
-      if (c->control_index_table[i] == uncompacted) {
-         brw_compact_inst_set_control_index(devinfo, dst, i);
-	 return true;
-      }
-   }
+   const int index = compact_table_find(c->control_index_lookup,
+                                        uncompacted);
+   if (index < 0)
+      return false;
 
-   return false;
+   brw_compact_inst_set_control_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1000,14 +1110,12 @@ set_datatype_index(const struct compaction_state *c, brw_compact_inst *dst,
                     (brw_inst_bits(src, 46, 35));        /* 12b */
    }
 
-   for (int i = 0; i < 32; i++) {
-      if (c->datatype_table[i] == uncompacted) {
-         brw_compact_inst_set_datatype_index(devinfo, dst, i);
-	 return true;
-      }
-   }
+   const int index = compact_table_find(c->datatype_lookup, uncompacted);
+   if (index < 0)
+      return false;
 
-   return false;
+   brw_compact_inst_set_datatype_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1015,8 +1123,6 @@ set_subreg_index(const struct compaction_state *c, brw_compact_inst *dst,
                  const brw_inst *src, bool is_immediate)
 {
    const struct intel_device_info *devinfo = c->isa->devinfo;
-   const unsigned table_len = devinfo->ver >= 20 ?
-      ARRAY_SIZE(xe2_subreg_table) : ARRAY_SIZE(g45_subreg_table);
    uint16_t uncompacted; /* 15b/G45+; 12b/Xe2+ */
 
    if (devinfo->ver >= 20) {
@@ -1038,14 +1144,12 @@ set_subreg_index(const struct compaction_state *c, brw_compact_inst *dst,
          uncompacted |= brw_inst_bits(src, 100, 96) << 10; /* 5b */
    }
 
-   for (int i = 0; i < table_len; i++) {
-      if (c->subreg_table[i] == uncompacted) {
-         brw_compact_inst_set_subreg_index(devinfo, dst, i);
-	 return true;
-      }
-   }
+   const int index = compact_table_find(c->subreg_lookup, uncompacted);
+   if (index < 0)
+      return false;
 
-   return false;
+   brw_compact_inst_set_subreg_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1054,11 +1158,8 @@ set_src0_index(const struct compaction_state *c, brw_compact_inst *dst,
 {
    const struct intel_device_info *devinfo = c->isa->devinfo;
    uint16_t uncompacted; /* 12b/G45+; 11b/Xe2+ */
-   int table_len;
 
    if (devinfo->ver >= 12) {
-      table_len = (devinfo->ver >= 20 ? ARRAY_SIZE(xe2_src0_index_table) :
-                   ARRAY_SIZE(gfx12_src0_index_table));
       uncompacted = (devinfo->ver >= 20 ? 0 :
                      brw_inst_bits(src, 87, 87) << 11) | /*  1b */
                     (brw_inst_bits(src, 86, 84) << 8) | /*  3b */
@@ -1067,18 +1168,15 @@ set_src0_index(const struct compaction_state *c, brw_compact_inst *dst,
                     (brw_inst_bits(src, 65, 64) << 2) | /*  2b */
                     (brw_inst_bits(src, 45, 44));       /*  2b */
    } else {
-      table_len = ARRAY_SIZE(gfx8_src_index_table);
       uncompacted = brw_inst_bits(src, 88, 77);         /* 12b */
    }
 
-   for (int i = 0; i < table_len; i++) {
-      if (c->src0_index_table[i] == uncompacted) {
-         brw_compact_inst_set_src0_index(devinfo, dst, i);
-	 return true;
-      }
-   }
+   const int index = compact_table_find(c->src0_index_lookup, uncompacted);
+   if (index < 0)
+      return false;
 
-   return false;
+   brw_compact_inst_set_src0_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1097,10 +1195,8 @@ set_src1_index(const struct compaction_state *c, brw_compact_inst *dst,
       return true;
    } else {
       uint16_t uncompacted; /* 12b/G45+ 16b/Xe2+ */
-      int table_len;
 
       if (devinfo->ver >= 20) {
-         table_len = ARRAY_SIZE(xe2_src1_index_table);
          uncompacted = (brw_inst_bits(src, 121, 120) << 14) | /*  2b */
                        (brw_inst_bits(src, 118, 116) << 11) | /*  3b */
                        (brw_inst_bits(src, 115, 113) <<  8) | /*  3b */
@@ -1108,26 +1204,23 @@ set_src1_index(const struct compaction_state *c, brw_compact_inst *dst,
                        (brw_inst_bits(src, 103,  99) <<  2) | /*  5b */
                        (brw_inst_bits(src,  97,  96));        /*  2b */
       } else if (devinfo->ver >= 12) {
-         table_len = ARRAY_SIZE(gfx12_src0_index_table);
          uncompacted = (brw_inst_bits(src, 121, 120) << 10) | /*  2b */
                        (brw_inst_bits(src, 119, 116) <<  6) | /*  4b */
                        (brw_inst_bits(src, 115, 113) <<  3) | /*  3b */
                        (brw_inst_bits(src, 112, 112) <<  2) | /*  1b */
                        (brw_inst_bits(src,  97,  96));        /*  2b */
       } else {
-         table_len = ARRAY_SIZE(gfx8_src_index_table);
          uncompacted = brw_inst_bits(src, 120, 109);          /* 12b */
       }
 
-      for (int i = 0; i < table_len; i++) {
-         if (c->src1_index_table[i] == uncompacted) {
-            brw_compact_inst_set_src1_index(devinfo, dst, i);
-            return true;
-         }
-      }
-   }
+      const int index = compact_table_find(c->src1_index_lookup,
+                                           uncompacted);
+      if (index < 0)
+         return false;
 
-   return false;
+      brw_compact_inst_set_src1_index(devinfo, dst, index);
+      return true;
+   }
 }
 
 static bool
@@ -1135,6 +1228,8 @@ set_3src_control_index(const struct intel_device_info *devinfo,
                        brw_compact_inst *dst, const brw_inst *src,
                        bool is_dpas)
 {
+   int index;
+
    if (devinfo->ver >= 20) {
       assert(is_dpas || !brw_inst_bits(src, 49, 49));
 
@@ -1159,16 +1254,10 @@ set_3src_control_index(const struct intel_device_info *devinfo,
       /* The bits used to index the tables for 3src and 3src-dpas
        * are the same, so just need to pick the right one.
        */
-      const uint64_t *table = is_dpas ? xe2_3src_dpas_control_index_table :
-                                        xe2_3src_control_index_table;
-      const unsigned size = is_dpas ? ARRAY_SIZE(xe2_3src_dpas_control_index_table) :
-                                      ARRAY_SIZE(xe2_3src_control_index_table);
-      for (unsigned i = 0; i < size; i++) {
-         if (table[i] == uncompacted) {
-            brw_compact_inst_set_3src_control_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      index = compact_table_find(is_dpas ?
+                                 &xe2_3src_dpas_control_index_table_lookup :
+                                 &xe2_3src_control_index_table_lookup,
+                                 uncompacted);
    } else if (devinfo->verx10 >= 125) {
       uint64_t uncompacted =             /* 37b/XeHP+ */
          (brw_inst_bits(src, 95, 92) << 33) | /*  4b */
@@ -1190,12 +1279,8 @@ set_3src_control_index(const struct intel_device_info *devinfo,
          (brw_inst_bits(src, 21, 19) <<  3) | /*  3b */
          (brw_inst_bits(src, 18, 16));        /*  3b */
 
-      for (unsigned i = 0; i < ARRAY_SIZE(xehp_3src_control_index_table); i++) {
-         if (xehp_3src_control_index_table[i] == uncompacted) {
-            brw_compact_inst_set_3src_control_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      index = compact_table_find(&xehp_3src_control_index_table_lookup,
+                                 uncompacted);
    } else if (devinfo->ver >= 12) {
       uint64_t uncompacted =             /* 36b/TGL+ */
          (brw_inst_bits(src, 95, 92) << 32) | /*  4b */
@@ -1217,27 +1302,23 @@ set_3src_control_index(const struct intel_device_info *devinfo,
          (brw_inst_bits(src, 21, 19) <<  3) | /*  3b */
          (brw_inst_bits(src, 18, 16));        /*  3b */
 
-      for (unsigned i = 0; i < ARRAY_SIZE(gfx12_3src_control_index_table); i++) {
-         if (gfx12_3src_control_index_table[i] == uncompacted) {
-            brw_compact_inst_set_3src_control_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      index = compact_table_find(&gfx12_3src_control_index_table_lookup,
+                                 uncompacted);
    } else {
       uint32_t uncompacted = /* 26b/SKL+ */
          (brw_inst_bits(src, 36, 35) << 24) |  /*  2b */
          (brw_inst_bits(src, 34, 32) << 21) |  /*  3b */
          (brw_inst_bits(src, 28,  8));         /* 21b */
 
-      for (unsigned i = 0; i < ARRAY_SIZE(gfx8_3src_control_index_table); i++) {
-         if (gfx8_3src_control_index_table[i] == uncompacted) {
-            brw_compact_inst_set_3src_control_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      index = compact_table_find(&gfx8_3src_control_index_table_lookup,
+                                 uncompacted);
    }
 
-   return false;
+   if (index < 0)
+      return false;
+
+   brw_compact_inst_set_3src_control_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1245,6 +1326,8 @@ set_3src_source_index(const struct intel_device_info *devinfo,
                       brw_compact_inst *dst, const brw_inst *src,
                       bool is_dpas)
 {
+   int index;
+
    if (devinfo->ver >= 12) {
       uint32_t uncompacted =               /* 21b/TGL+ */
          (brw_inst_bits(src, 114, 114) << 20) | /*  1b */
@@ -1266,23 +1349,13 @@ set_3src_source_index(const struct intel_device_info *devinfo,
       /* In Xe2, the bits used to index the tables for 3src and 3src-dpas
        * are the same, so just need to pick the right one.
        */
-      const uint32_t *three_src_source_index_table =
-         devinfo->ver >= 20 ? (is_dpas ? xe2_3src_dpas_source_index_table :
-                                         xe2_3src_source_index_table) :
-         devinfo->verx10 >= 125 ? xehp_3src_source_index_table :
-         gfx12_3src_source_index_table;
-      const uint32_t three_src_source_index_table_len =
-         devinfo->ver >= 20 ? (is_dpas ? ARRAY_SIZE(xe2_3src_dpas_source_index_table) :
-                                         ARRAY_SIZE(xe2_3src_source_index_table)) :
-         devinfo->verx10 >= 125 ? ARRAY_SIZE(xehp_3src_source_index_table) :
-         ARRAY_SIZE(gfx12_3src_source_index_table);
-
-      for (unsigned i = 0; i < three_src_source_index_table_len; i++) {
-         if (three_src_source_index_table[i] == uncompacted) {
-            brw_compact_inst_set_3src_source_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      struct compact_table_lookup *lookup =
+         devinfo->ver >= 20 ? (is_dpas ? &xe2_3src_dpas_source_index_table_lookup :
+                                         &xe2_3src_source_index_table_lookup) :
+         devinfo->verx10 >= 125 ? &xehp_3src_source_index_table_lookup :
+         &gfx12_3src_source_index_table_lookup;
+
+      index = compact_table_find(lookup, uncompacted);
    } else {
       uint64_t uncompacted =    /* 49b/SKL+ */
          (brw_inst_bits(src, 126, 125) << 47) |   /*  2b */
@@ -1294,15 +1367,15 @@ set_3src_source_index(const struct intel_device_info *devinfo,
          (brw_inst_bits(src,  72,  65) << 19) |   /*  8b */
          (brw_inst_bits(src,  55,  37));          /* 19b */
 
-      for (unsigned i = 0; i < ARRAY_SIZE(gfx8_3src_source_index_table); i++) {
-         if (gfx8_3src_source_index_table[i] == uncompacted) {
-            brw_compact_inst_set_3src_source_index(devinfo, dst, i);
-            return true;
-         }
-      }
+      index = compact_table_find(&gfx8_3src_source_index_table_lookup,
+                                 uncompacted);
    }
 
-   return false;
+   if (index < 0)
+      return false;
+
+   brw_compact_inst_set_3src_source_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -1317,20 +1390,15 @@ set_3src_subreg_index(const struct intel_device_info *devinfo,
       (brw_inst_bits(src,  71,  67) <<  5) | /*  5b */
       (brw_inst_bits(src,  55,  51));        /*  5b */
 
-   const uint32_t *table = devinfo->ver >= 20 ? xe2_3src_subreg_table :
-                           gfx12_3src_subreg_table;
-   const uint32_t len =
-      devinfo->ver >= 20 ? ARRAY_SIZE(xe2_3src_subreg_table) :
-      ARRAY_SIZE(gfx12_3src_subreg_table);
-
-   for (unsigned i = 0; i < len; i++) {
-      if (table[i] == uncompacted) {
-         brw_compact_inst_set_3src_subreg_index(devinfo, dst, i);
-	 return true;
-      }
-   }
+   const int index =
+      compact_table_find(devinfo->ver >= 20 ? &xe2_3src_subreg_table_lookup :
+                                              &gfx12_3src_subreg_table_lookup,
+                         uncompacted);
+   if (index < 0)
+      return false;
 
-   return false;
+   brw_compact_inst_set_3src_subreg_index(devinfo, dst, index);
+   return true;
 }
 
 static bool
@@ -2294,17 +2362,29 @@ compaction_state_init(struct compaction_state *c,
       c->subreg_table = xe2_subreg_table;
       c->src0_index_table = xe2_src0_index_table;
       c->src1_index_table = xe2_src1_index_table;
+      c->control_index_lookup = &xe2_control_index_table_lookup;
+      c->datatype_lookup = &xe2_datatype_table_lookup;
+      c->subreg_lookup = &xe2_subreg_table_lookup;
+      c->src0_index_lookup = &xe2_src0_index_table_lookup;
+      c->src1_index_lookup = &xe2_src1_index_table_lookup;
       break;
    case 12:
       c->control_index_table = gfx12_control_index_table;;
       c->datatype_table = gfx12_datatype_table;
       c->subreg_table = gfx12_subreg_table;
+      c->control_index_lookup = &gfx12_control_index_table_lookup;
+      c->datatype_lookup = &gfx12_datatype_table_lookup;
+      c->subreg_lookup = &gfx12_subreg_table_lookup;
       if (devinfo->verx10 >= 125) {
          c->src0_index_table = xehp_src0_index_table;
          c->src1_index_table = xehp_src1_index_table;
+         c->src0_index_lookup = &xehp_src0_index_table_lookup;
+         c->src1_index_lookup = &xehp_src1_index_table_lookup;
       } else {
          c->src0_index_table = gfx12_src0_index_table;
          c->src1_index_table = gfx12_src1_index_table;
+         c->src0_index_lookup = &gfx12_src0_index_table_lookup;
+         c->src1_index_lookup = &gfx12_src1_index_table_lookup;
       }
       break;
    case 11:
@@ -2313,6 +2393,11 @@ compaction_state_init(struct compaction_state *c,
       c->subreg_table = gfx8_subreg_table;
       c->src0_index_table = gfx8_src_index_table;
       c->src1_index_table = gfx8_src_index_table;
+      c->control_index_lookup = &gfx8_control_index_table_lookup;
+      c->datatype_lookup = &gfx11_datatype_table_lookup;
+      c->subreg_lookup = &gfx8_subreg_table_lookup;
+      c->src0_index_lookup = &gfx8_src_index_table_lookup;
+      c->src1_index_lookup = &gfx8_src_index_table_lookup;
       break;
    case 9:
       c->control_index_table = gfx8_control_index_table;
@@ -2320,6 +2405,11 @@ compaction_state_init(struct compaction_state *c,
       c->subreg_table = gfx8_subreg_table;
       c->src0_index_table = gfx8_src_index_table;
       c->src1_index_table = gfx8_src_index_table;
+      c->control_index_lookup = &gfx8_control_index_table_lookup;
+      c->datatype_lookup = &gfx8_datatype_table_lookup;
+      c->subreg_lookup = &gfx8_subreg_table_lookup;
+      c->src0_index_lookup = &gfx8_src_index_table_lookup;
+      c->src1_index_lookup = &gfx8_src_index_table_lookup;
       break;
    default:
       unreachable("unknown generation");
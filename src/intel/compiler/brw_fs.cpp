@@ -41,6 +41,7 @@
 #include "dev/intel_wa.h"
 #include "compiler/glsl_types.h"
 #include "compiler/nir/nir_builder.h"
+#include "util/os_time.h"
 #include "util/u_math.h"
 
 using namespace brw;
@@ -1352,12 +1353,15 @@ brw::register_pressure::~register_pressure()
 }
 
 void
-fs_visitor::invalidate_analysis(brw::analysis_dependency_class c)
+fs_visitor::invalidate_analysis(brw::analysis_dependency_class c,
+                                unsigned keep)
 {
    live_analysis.invalidate(c);
    regpressure_analysis.invalidate(c);
    idom_analysis.invalidate(c);
    def_analysis.invalidate(c);
+   if (!(keep & brw::KEEP_REGISTER_FOOTPRINT))
+      footprint_analysis.invalidate(c);
 }
 
 void
@@ -1379,7 +1383,17 @@ fs_visitor::debug_optimizer(const nir_shader *nir,
    free(filename);
 }
 
-static uint32_t
+/**
+ * Report how long an optimization pass or a compilation phase took to the
+ * report_pass_time callback the caller passed in.
+ */
+void
+fs_visitor::debug_pass_time(const char *pass_name, int64_t duration_ns) const
+{
+   report_pass_time(log_data, stage, dispatch_width, pass_name, duration_ns);
+}
+
+uint32_t
 brw_compute_max_register_pressure(fs_visitor &s)
 {
    const register_pressure &rp = s.regpressure_analysis.require();
@@ -1391,6 +1405,56 @@ brw_compute_max_register_pressure(fs_visitor &s)
    return max_pressure;
 }
 
+/**
+ * Returns true if register allocation is bound to fail without spilling for
+ * the current instruction order.
+ *
+ * Virtual GRFs live across the same instruction interfere with each other
+ * and with the payload registers still in use at that point, so if they
+ * don't fit in the register file together no coloring exists.  This only
+ * needs the liveness information the allocator is going to use anyway, and
+ * is much cheaper than building the interference graph.
+ */
+static bool
+brw_register_pressure_exceeds_grf_file(fs_visitor &s)
+{
+   const fs_live_variables &live = s.live_analysis.require();
+   const unsigned num_insts = s.cfg->last_block()->end_ip + 1;
+   int *delta = new int[num_insts + 1]();
+
+   for (unsigned i = 0; i < s.alloc.count; i++) {
+      if (live.vgrf_start[i] >= live.vgrf_end[i])
+         continue;
+
+      const int size = DIV_ROUND_UP(s.alloc.sizes[i], reg_unit(s.devinfo));
+      delta[live.vgrf_start[i]] += size;
+      delta[live.vgrf_end[i]] -= size;
+   }
+
+   const unsigned payload_count = s.first_non_payload_grf;
+   int *payload_last_use_ip = new int[payload_count];
+   s.calculate_payload_ranges(false, payload_count, payload_last_use_ip);
+
+   for (unsigned i = 0; i < payload_count; i++) {
+      if (payload_last_use_ip[i] >= 0) {
+         delta[0]++;
+         delta[payload_last_use_ip[i] + 1]--;
+      }
+   }
+
+   bool exceeds = false;
+   int live_regs = 0;
+   for (unsigned ip = 0; ip < num_insts && !exceeds; ip++) {
+      live_regs += delta[ip];
+      exceeds = live_regs > BRW_MAX_GRF;
+   }
+
+   delete[] payload_last_use_ip;
+   delete[] delta;
+
+   return exceeds;
+}
+
 static fs_inst **
 save_instruction_order(const struct cfg_t *cfg)
 {
@@ -1439,7 +1503,7 @@ brw_allocate_registers(fs_visitor &s, bool allow_spilling)
 {
    const struct intel_device_info *devinfo = s.devinfo;
    const nir_shader *nir = s.nir;
-   bool allocated;
+   bool allocated = false;
 
    static const enum instruction_scheduler_mode pre_modes[] = {
       SCHEDULE_PRE,
@@ -1474,6 +1538,14 @@ brw_allocate_registers(fs_visitor &s, bool allow_spilling)
     */
    fs_inst **orig_order = save_instruction_order(s.cfg);
    fs_inst **best_pressure_order = NULL;
+   const unsigned num_insts = s.cfg->last_block()->end_ip + 1;
+
+   /* The instruction order produced by each mode tried so far.  Different
+    * heuristics often come up with the same order, in which case we already
+    * know it doesn't allocate.
+    */
+   fs_inst **tried_order[ARRAY_SIZE(pre_modes)];
+   unsigned num_tried = 0;
 
    void *scheduler_ctx = ralloc_context(NULL);
    instruction_scheduler *sched = brw_prepare_scheduler(s, scheduler_ctx);
@@ -1496,12 +1568,33 @@ brw_allocate_registers(fs_visitor &s, bool allow_spilling)
          break;
       }
 
+      fs_inst **order = save_instruction_order(s.cfg);
+      bool already_tried = false;
+      for (unsigned j = 0; j < num_tried && !already_tried; j++) {
+         already_tried = memcmp(tried_order[j], order,
+                                num_insts * sizeof(*order)) == 0;
+      }
+
+      if (already_tried) {
+         delete[] order;
+         restore_instruction_order(s.cfg, orig_order);
+         s.invalidate_analysis(DEPENDENCY_INSTRUCTIONS);
+         continue;
+      }
+
+      tried_order[num_tried++] = order;
+
       /* We should only spill registers on the last scheduling. */
       assert(!s.spilled_any_registers);
 
-      allocated = brw_assign_regs(s, false, spill_all);
-      if (allocated)
-         break;
+      /* Don't bother building the interference graph if the liveness alone
+       * shows this order can't be allocated.
+       */
+      if (spill_all || !brw_register_pressure_exceeds_grf_file(s)) {
+         allocated = brw_assign_regs(s, false, spill_all);
+         if (allocated)
+            break;
+      }
 
       /* Save the maximum register pressure */
       uint32_t this_pressure = brw_compute_max_register_pressure(s);
@@ -1514,8 +1607,7 @@ brw_allocate_registers(fs_visitor &s, bool allow_spilling)
       if (this_pressure < best_register_pressure) {
          best_register_pressure = this_pressure;
          best_sched = sched_mode;
-         delete[] best_pressure_order;
-         best_pressure_order = save_instruction_order(s.cfg);
+         best_pressure_order = order;
       }
 
       /* Reset back to the original order before trying the next mode */
@@ -1537,7 +1629,8 @@ brw_allocate_registers(fs_visitor &s, bool allow_spilling)
    }
 
    delete[] orig_order;
-   delete[] best_pressure_order;
+   for (unsigned i = 0; i < num_tried; i++)
+      delete[] tried_order[i];
 
    if (!allocated) {
       s.fail("Failure to register allocate.  Reduce number of "
@@ -1768,6 +1861,24 @@ brw_shader_phase_update(fs_visitor &s, enum brw_shader_phase phase)
    assert(phase == s.phase + 1);
    s.phase = phase;
    brw_fs_validate(s);
+
+   if (s.report_pass_time) {
+      /* Indexed by brw_shader_phase. */
+      static const char *phase_name[] = {
+         NULL,
+         "phase:nir_to_brw",
+         "phase:opt_loop",
+         "phase:early_lowering",
+         "phase:middle_lowering",
+         "phase:late_lowering",
+         "phase:regalloc",
+      };
+      const int64_t now = os_time_get_nano();
+
+      assert(phase < ARRAY_SIZE(phase_name) && phase_name[phase]);
+      s.debug_pass_time(phase_name[phase], now - s.phase_start_time);
+      s.phase_start_time = now;
+   }
 }
 
 bool brw_should_print_shader(const nir_shader *shader, uint64_t debug_flag)
@@ -123,6 +123,100 @@ namespace brw {
       uint32_t *def_use_counts;
       unsigned def_count;
    };
+
+   /**
+    * GRF footprint of every instruction of a register-allocated shader,
+    * stored as flat arrays indexed by IP, so that the post-RA passes don't
+    * need to repeat the regioning math of regs_read() and regs_written()
+    * each time they walk the program.
+    *
+    * The post-RA passes keep it up to date as they change the program and
+    * pass KEEP_REGISTER_FOOTPRINT to fs_visitor::invalidate_analysis(), so
+    * a single instance is shared from bank conflict mitigation to scoreboard
+    * lowering.
+    */
+   class register_footprint {
+   public:
+      register_footprint(const fs_visitor *v);
+      ~register_footprint();
+
+      /**
+       * Registers accessed by one operand of an instruction.  \p start and
+       * \p len are in GRF units and are only valid for VGRF and FIXED_GRF
+       * operands, the former only after register allocation.
+       */
+      struct range {
+         uint16_t start;
+         uint8_t len;
+         uint8_t file;
+
+         bool
+         is_grf() const
+         {
+            return file == VGRF || file == FIXED_GRF;
+         }
+
+         bool
+         operator==(const range &r) const
+         {
+            return start == r.start && len == r.len && file == r.file;
+         }
+      };
+
+      const range &
+      dst(unsigned ip) const
+      {
+         assert(ip < num_insts);
+         return ranges[offsets[ip]];
+      }
+
+      const range &
+      src(unsigned ip, unsigned i) const
+      {
+         assert(ip < num_insts && offsets[ip] + 1 + i < offsets[ip + 1]);
+         return ranges[offsets[ip] + 1 + i];
+      }
+
+      range &
+      dst(unsigned ip)
+      {
+         assert(ip < num_insts);
+         return ranges[offsets[ip]];
+      }
+
+      range &
+      src(unsigned ip, unsigned i)
+      {
+         assert(ip < num_insts && offsets[ip] + 1 + i < offsets[ip + 1]);
+         return ranges[offsets[ip] + 1 + i];
+      }
+
+      void reorder(const unsigned *old_ips);
+      void lower_vgrfs_to_fixed_grfs();
+
+      analysis_dependency_class
+      dependency_class() const
+      {
+         return DEPENDENCY_INSTRUCTIONS;
+      }
+
+      bool validate(const fs_visitor *) const;
+      bool equals(const register_footprint &fp) const;
+
+   private:
+      unsigned num_insts;
+      unsigned *offsets;
+      range *ranges;
+   };
+
+   /**
+    * Analyses that a pass brought up to date with its own changes, which
+    * fs_visitor::invalidate_analysis() leaves alone.
+    */
+   enum analysis_keep_mask {
+      KEEP_NOTHING = 0,
+      KEEP_REGISTER_FOOTPRINT = 0x1,
+   };
 }
 
 #define UBO_START ((1 << 16) - 4)
@@ -316,7 +410,8 @@ public:
    void assign_constant_locations();
    bool get_pull_locs(const brw_reg &src, unsigned *out_surf_index,
                       unsigned *out_pull_index);
-   void invalidate_analysis(brw::analysis_dependency_class c);
+   void invalidate_analysis(brw::analysis_dependency_class c,
+                            unsigned keep = brw::KEEP_NOTHING);
 
    void vfail(const char *msg, va_list args);
    void fail(const char *msg, ...);
@@ -332,6 +427,11 @@ public:
    const struct brw_compiler *compiler;
    void *log_data; /* Passed to compiler->*_log functions */
 
+   /** See brw_compile_params::report_pass_time. */
+   void (*report_pass_time)(void *log_data, gl_shader_stage stage,
+                            unsigned dispatch_width, const char *pass,
+                            uint64_t duration_ns);
+
    const struct intel_device_info * const devinfo;
    const nir_shader *nir;
 
@@ -359,6 +459,7 @@ public:
    brw_analysis<brw::performance, fs_visitor> performance_analysis;
    brw_analysis<brw::idom_tree, fs_visitor> idom_analysis;
    brw_analysis<brw::def_analysis, fs_visitor> def_analysis;
+   brw_analysis<brw::register_footprint, fs_visitor> footprint_analysis;
 
    /** Number of uniform variable components visited. */
    unsigned uniforms;
@@ -381,6 +482,9 @@ public:
 
    enum brw_shader_phase phase;
 
+   /** Start time of the current phase, for report_pass_time. */
+   int64_t phase_start_time;
+
    bool failed;
    char *fail_msg;
 
@@ -455,6 +559,27 @@ public:
    const unsigned max_polygons;
    unsigned max_dispatch_width;
 
+   /**
+    * Performance and register pressure estimates taken right before RA,
+    * only for SIMD32 fragment shaders.
+    */
+   float pre_ra_throughput;
+   unsigned pre_ra_pressure;
+
+   /**
+    * Throughput estimate of the best narrower variant already kept for this
+    * shader.  A SIMD32 compile predicted to lose against it is abandoned
+    * before register allocation.  Zero disables the early-out.
+    */
+   float simd32_min_throughput;
+
+   /**
+    * Reason the pre-RA estimates gave for abandoning this SIMD32 variant,
+    * kept instead of failing the compile when INTEL_DEBUG=do32 forces
+    * SIMD32 so that mispredictions can be reported.
+    */
+   const char *simd32_early_out;
+
    /* The API selected subgroup size */
    unsigned api_subgroup_size; /**< 0, 8, 16, 32 */
 
@@ -463,6 +588,7 @@ public:
    void debug_optimizer(const nir_shader *nir,
                         const char *pass_name,
                         int iteration, int pass_num) const;
+   void debug_pass_time(const char *pass_name, int64_t duration_ns) const;
 };
 
 void brw_print_instruction_to_file(const fs_visitor &s, const fs_inst *inst, FILE *file, const brw::def_analysis *defs);
@@ -627,6 +753,7 @@ void brw_schedule_instructions_pre_ra(fs_visitor &s, instruction_scheduler *sche
                                       instruction_scheduler_mode mode);
 void brw_schedule_instructions_post_ra(fs_visitor &s);
 
+uint32_t brw_compute_max_register_pressure(fs_visitor &s);
 void brw_allocate_registers(fs_visitor &s, bool allow_spilling);
 bool brw_assign_regs(fs_visitor &s, bool allow_spilling, bool spill_all);
 void brw_assign_regs_trivial(fs_visitor &s);
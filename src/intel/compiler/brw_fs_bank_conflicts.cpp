@@ -51,6 +51,8 @@
 #include "brw_fs.h"
 #include "brw_cfg.h"
 
+using namespace brw;
+
 #ifdef __SSE2__
 
 #include <emmintrin.h>
@@ -507,18 +509,23 @@ namespace {
     * the program.
     */
    partitioning
-   shader_reg_partitioning(const fs_visitor *v)
+   shader_reg_partitioning(const fs_visitor *v, const register_footprint &fp)
    {
       partitioning p(BRW_MAX_GRF);
+      unsigned ip = 0;
 
       foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
-         if (is_grf(inst->dst))
-            p.require_contiguous(reg_of(inst->dst), regs_written(inst));
+         const register_footprint::range &dst = fp.dst(ip);
+         if (dst.is_grf())
+            p.require_contiguous(dst.start, dst.len);
 
          for (int i = 0; i < inst->sources; i++) {
-            if (is_grf(inst->src[i]))
-               p.require_contiguous(reg_of(inst->src[i]), regs_read(inst, i));
+            const register_footprint::range &src = fp.src(ip, i);
+            if (src.is_grf())
+               p.require_contiguous(src.start, src.len);
          }
+
+         ip++;
       }
 
       return p;
@@ -529,7 +536,8 @@ namespace {
     * original location to avoid violating hardware or software assumptions.
     */
    bool *
-   shader_reg_constraints(const fs_visitor *v, const partitioning &p)
+   shader_reg_constraints(const fs_visitor *v, const register_footprint &fp,
+                          const partitioning &p)
    {
       bool *constrained = new bool[p.num_atoms()]();
 
@@ -551,20 +559,25 @@ namespace {
        */
       constrained[p.atom_of_reg(127)] = true;
 
+      unsigned ip = 0;
+
       foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
          /* Assume that anything referenced via fixed GRFs is baked into the
           * hardware's fixed-function logic and may be unsafe to move around.
           * Also take into account the source GRF restrictions of EOT
           * send-message instructions.
           */
-         if (inst->dst.file == FIXED_GRF)
-            constrained[p.atom_of_reg(reg_of(inst->dst))] = true;
+         const register_footprint::range &dst = fp.dst(ip);
+         if (dst.file == FIXED_GRF)
+            constrained[p.atom_of_reg(dst.start)] = true;
 
          for (int i = 0; i < inst->sources; i++) {
-            if (inst->src[i].file == FIXED_GRF ||
-                (is_grf(inst->src[i]) && inst->eot))
-               constrained[p.atom_of_reg(reg_of(inst->src[i]))] = true;
+            const register_footprint::range &src = fp.src(ip, i);
+            if (src.file == FIXED_GRF || (src.is_grf() && inst->eot))
+               constrained[p.atom_of_reg(src.start)] = true;
          }
+
+         ip++;
       }
 
       return constrained;
@@ -606,7 +619,9 @@ namespace {
     *           helpful than not optimizing at all.
     */
    weight_vector_type *
-   shader_conflict_weight_matrix(const fs_visitor *v, const partitioning &p)
+   shader_conflict_weight_matrix(const fs_visitor *v,
+                                 const register_footprint &fp,
+                                 const partitioning &p)
    {
       weight_vector_type *conflicts = new weight_vector_type[p.num_atoms()];
       for (unsigned r = 0; r < p.num_atoms(); r++)
@@ -616,6 +631,7 @@ namespace {
        * will be executed at run-time.
        */
       unsigned block_scale = 1;
+      unsigned ip = 0;
 
       foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
          if (inst->opcode == BRW_OPCODE_DO) {
@@ -625,9 +641,11 @@ namespace {
             block_scale /= 10;
 
          } else if (inst->is_3src(v->compiler) &&
-                    is_grf(inst->src[1]) && is_grf(inst->src[2])) {
-            const unsigned r = p.atom_of_reg(reg_of(inst->src[1]));
-            const unsigned s = p.atom_of_reg(reg_of(inst->src[2]));
+                    fp.src(ip, 1).is_grf() && fp.src(ip, 2).is_grf()) {
+            const unsigned reg_r = fp.src(ip, 1).start;
+            const unsigned reg_s = fp.src(ip, 2).start;
+            const unsigned r = p.atom_of_reg(reg_r);
+            const unsigned s = p.atom_of_reg(reg_s);
 
             /* Estimate of the cycle-count cost of incurring a bank conflict
              * for this instruction.  This is only true on the average, for a
@@ -653,8 +671,8 @@ namespace {
                 * incur a conflict iff they are assigned opposite banks (b and
                 * b^1).
                 */
-               const bool p_r = 1 & (reg_of(inst->src[1]) - p.reg_of_atom(r));
-               const bool p_s = 1 & (reg_of(inst->src[2]) - p.reg_of_atom(s));
+               const bool p_r = 1 & (reg_r - p.reg_of_atom(r));
+               const bool p_s = 1 & (reg_s - p.reg_of_atom(s));
                const unsigned p = p_r ^ p_s;
 
                /* Calculate the updated cost of a hypothetical conflict
@@ -667,6 +685,8 @@ namespace {
                set(conflicts[s], r, p, w);
             }
          }
+
+         ip++;
       }
 
       return conflicts;
@@ -883,6 +903,20 @@ namespace {
 
       return r;
    }
+
+   /**
+    * Apply the same transformation to the register footprint of an
+    * operand.
+    */
+   void
+   transform(const partitioning &p, const permutation &map,
+             register_footprint::range &r)
+   {
+      if (r.file == VGRF) {
+         const unsigned s = p.atom_of_reg(r.start);
+         r.start = map.v[s] + r.start - p.reg_of_atom(s);
+      }
+   }
 }
 
 bool
@@ -894,23 +928,36 @@ brw_fs_opt_bank_conflicts(fs_visitor &s)
    if (s.devinfo->ver >= 20)
       return false;
 
-   const partitioning p = shader_reg_partitioning(&s);
-   const bool *constrained = shader_reg_constraints(&s, p);
+   register_footprint &fp = s.footprint_analysis.require();
+   const partitioning p = shader_reg_partitioning(&s, fp);
+   const bool *constrained = shader_reg_constraints(&s, fp, p);
    const weight_vector_type *conflicts =
-      shader_conflict_weight_matrix(&s, p);
+      shader_conflict_weight_matrix(&s, fp, p);
    const permutation map =
       optimize_reg_permutation(p, constrained, conflicts,
                                identity_reg_permutation(p));
 
+   unsigned ip = 0;
+
    foreach_block_and_inst(block, fs_inst, inst, s.cfg) {
       inst->dst = transform(p, map, inst->dst);
+      transform(p, map, fp.dst(ip));
 
-      for (int i = 0; i < inst->sources; i++)
+      for (int i = 0; i < inst->sources; i++) {
          inst->src[i] = transform(p, map, inst->src[i]);
+         transform(p, map, fp.src(ip, i));
+      }
+
+      ip++;
    }
 
    delete[] conflicts;
    delete[] constrained;
+
+   assert(fp.equals(register_footprint(&s)));
+   s.invalidate_analysis(DEPENDENCY_INSTRUCTION_DETAIL |
+                         DEPENDENCY_INSTRUCTION_DATA_FLOW,
+                         KEEP_REGISTER_FOOTPRINT);
    return true;
 }
 
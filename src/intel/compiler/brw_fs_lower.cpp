@@ -758,6 +758,8 @@ brw_fs_lower_vgrfs_to_fixed_grfs(fs_visitor &s)
 {
    assert(s.grf_used || !"Must be called after register allocation");
 
+   register_footprint &fp = s.footprint_analysis.require();
+
    foreach_block_and_inst(block, fs_inst, inst, s.cfg) {
       /* If the instruction writes to more than one register, it needs to be
        * explicitly marked as compressed on Gen <= 5.  On Gen >= 6 the
@@ -782,8 +784,11 @@ brw_fs_lower_vgrfs_to_fixed_grfs(fs_visitor &s)
       }
    }
 
+   fp.lower_vgrfs_to_fixed_grfs();
+   assert(fp.equals(register_footprint(&s)));
+
    s.invalidate_analysis(DEPENDENCY_INSTRUCTION_DATA_FLOW |
-                         DEPENDENCY_VARIABLES);
+                         DEPENDENCY_VARIABLES, KEEP_REGISTER_FOOTPRINT);
 }
 
 bool
@@ -6,6 +6,8 @@
 #include "brw_eu.h"
 #include "brw_fs.h"
 #include "brw_fs_builder.h"
+#include "dev/intel_debug.h"
+#include "util/os_time.h"
 
 using namespace brw;
 
@@ -32,8 +34,13 @@ brw_fs_optimize(fs_visitor &s)
 
 #define OPT(pass, ...) ({                                               \
       pass_num++;                                                       \
+      const int64_t pass_start =                                        \
+         s.report_pass_time ? os_time_get_nano() : 0;                   \
       bool this_progress = pass(s, ##__VA_ARGS__);                      \
                                                                         \
+      if (pass_start)                                                   \
+         s.debug_pass_time(#pass, os_time_get_nano() - pass_start);     \
+                                                                        \
       if (this_progress)                                                \
          s.debug_optimizer(nir, #pass, iteration, pass_num);            \
                                                                         \
@@ -677,6 +677,26 @@ namespace {
             *p = d;
       }
 
+      /**
+       * Look up the most current data dependency for GRF number \p reg.
+       */
+      dependency
+      get_grf(unsigned reg) const
+      {
+         assert(reg < ARRAY_SIZE(grf_deps));
+         return grf_deps[reg];
+      }
+
+      /**
+       * Specify the most current data dependency for GRF number \p reg.
+       */
+      void
+      set_grf(unsigned reg, const dependency &d)
+      {
+         assert(reg < ARRAY_SIZE(grf_deps));
+         grf_deps[reg] = d;
+      }
+
       /**
        * Component-wise merge() of corresponding dependencies from two
        * scoreboard objects.  \sa merge().
@@ -1011,6 +1031,7 @@ namespace {
     */
    void
    update_inst_scoreboard(const fs_visitor *shader, const ordered_address *jps,
+                          const register_footprint &fp,
                           const fs_inst *inst, unsigned ip, scoreboard &sb)
    {
       const bool exec_all = inst->force_writemask_all;
@@ -1036,10 +1057,18 @@ namespace {
              is_unordered_math) ? dependency(TGL_SBID_SRC, ip, exec_all) :
             is_ordered ? dependency(TGL_REGDIST_SRC, jp, exec_all) :
             dependency::done;
+         const register_footprint::range &src = fp.src(ip, i);
 
-         for (unsigned j = 0; j < regs_read(inst, i); j++) {
-            const brw_reg r = byte_offset(inst->src[i], REG_SIZE * j);
-            sb.set(r, shadow(sb.get(r), rd_dep));
+         if (src.is_grf()) {
+            for (unsigned j = 0; j < src.len; j++) {
+               const unsigned r = src.start + j;
+               sb.set_grf(r, shadow(sb.get_grf(r), rd_dep));
+            }
+         } else {
+            for (unsigned j = 0; j < regs_read(inst, i); j++) {
+               const brw_reg r = byte_offset(inst->src[i], REG_SIZE * j);
+               sb.set(r, shadow(sb.get(r), rd_dep));
+            }
          }
       }
 
@@ -1057,8 +1086,15 @@ namespace {
 
       if (is_valid(wr_dep) && inst->dst.file != BAD_FILE &&
           !inst->dst.is_null()) {
-         for (unsigned j = 0; j < regs_written(inst); j++)
-            sb.set(byte_offset(inst->dst, REG_SIZE * j), wr_dep);
+         const register_footprint::range &dst = fp.dst(ip);
+
+         if (dst.is_grf()) {
+            for (unsigned j = 0; j < dst.len; j++)
+               sb.set_grf(dst.start + j, wr_dep);
+         } else {
+            for (unsigned j = 0; j < regs_written(inst); j++)
+               sb.set(byte_offset(inst->dst, REG_SIZE * j), wr_dep);
+         }
       }
    }
 
@@ -1069,13 +1105,14 @@ namespace {
     */
    scoreboard *
    gather_block_scoreboards(const fs_visitor *shader,
-                            const ordered_address *jps)
+                            const ordered_address *jps,
+                            const register_footprint &fp)
    {
       scoreboard *sbs = new scoreboard[shader->cfg->num_blocks];
       unsigned ip = 0;
 
       foreach_block_and_inst(block, fs_inst, inst, shader->cfg)
-         update_inst_scoreboard(shader, jps, inst, ip++, sbs[block->num]);
+         update_inst_scoreboard(shader, jps, fp, inst, ip++, sbs[block->num]);
 
       return sbs;
    }
@@ -1090,9 +1127,10 @@ namespace {
    scoreboard *
    propagate_block_scoreboards(const fs_visitor *shader,
                                const ordered_address *jps,
+                               const register_footprint &fp,
                                equivalence_relation &eq)
    {
-      const scoreboard *delta_sbs = gather_block_scoreboards(shader, jps);
+      const scoreboard *delta_sbs = gather_block_scoreboards(shader, jps, fp);
       scoreboard *in_sbs = new scoreboard[shader->cfg->num_blocks];
       scoreboard *out_sbs = new scoreboard[shader->cfg->num_blocks];
 
@@ -1139,8 +1177,9 @@ namespace {
                             const ordered_address *jps)
    {
       const struct intel_device_info *devinfo = shader->devinfo;
+      const register_footprint &fp = shader->footprint_analysis.require();
       equivalence_relation eq(num_instructions(shader));
-      scoreboard *sbs = propagate_block_scoreboards(shader, jps, eq);
+      scoreboard *sbs = propagate_block_scoreboards(shader, jps, fp, eq);
       const unsigned *ids = eq.flatten();
       dependency_list *deps = new dependency_list[num_instructions(shader)];
       unsigned ip = 0;
@@ -1151,9 +1190,17 @@ namespace {
          scoreboard &sb = sbs[block->num];
 
          for (unsigned i = 0; i < inst->sources; i++) {
-            for (unsigned j = 0; j < regs_read(inst, i); j++)
-               add_dependency(ids, deps[ip], dependency_for_read(
-                  sb.get(byte_offset(inst->src[i], REG_SIZE * j))));
+            const register_footprint::range &src = fp.src(ip, i);
+
+            if (src.is_grf()) {
+               for (unsigned j = 0; j < src.len; j++)
+                  add_dependency(ids, deps[ip], dependency_for_read(
+                     sb.get_grf(src.start + j)));
+            } else {
+               for (unsigned j = 0; j < regs_read(inst, i); j++)
+                  add_dependency(ids, deps[ip], dependency_for_read(
+                     sb.get(byte_offset(inst->src[i], REG_SIZE * j))));
+            }
          }
 
          if (inst->reads_accumulator_implicitly()) {
@@ -1175,9 +1222,18 @@ namespace {
          if (!inst->no_dd_check) {
             if (inst->dst.file != BAD_FILE && !inst->dst.is_null() &&
                 !inst->dst.is_accumulator()) {
-               for (unsigned j = 0; j < regs_written(inst); j++) {
-                  add_dependency(ids, deps[ip], dependency_for_write(devinfo, inst,
-                     sb.get(byte_offset(inst->dst, REG_SIZE * j))));
+               const register_footprint::range &dst = fp.dst(ip);
+
+               if (dst.is_grf()) {
+                  for (unsigned j = 0; j < dst.len; j++) {
+                     add_dependency(ids, deps[ip], dependency_for_write(devinfo, inst,
+                        sb.get_grf(dst.start + j)));
+                  }
+               } else {
+                  for (unsigned j = 0; j < regs_written(inst); j++) {
+                     add_dependency(ids, deps[ip], dependency_for_write(devinfo, inst,
+                        sb.get(byte_offset(inst->dst, REG_SIZE * j))));
+                  }
                }
             }
 
@@ -1195,7 +1251,7 @@ namespace {
             }
          }
 
-         update_inst_scoreboard(shader, jps, inst, ip, sb);
+         update_inst_scoreboard(shader, jps, fp, inst, ip, sb);
          ip++;
       }
 
@@ -1340,6 +1396,8 @@ brw_fs_lower_scoreboard(fs_visitor &s)
       delete[] deps1;
       delete[] deps0;
       delete[] jps;
+
+      s.invalidate_analysis(DEPENDENCY_INSTRUCTIONS);
    }
 
    return true;
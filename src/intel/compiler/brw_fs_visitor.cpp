@@ -32,7 +32,9 @@
 #include "brw_fs_builder.h"
 #include "brw_nir.h"
 #include "compiler/glsl_types.h"
+#include "dev/intel_debug.h"
 #include "dev/intel_device_info.h"
+#include "util/os_time.h"
 
 using namespace brw;
 
@@ -379,6 +381,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
                        bool needs_register_pressure,
                        bool debug_enabled)
    : compiler(compiler), log_data(params->log_data),
+     report_pass_time(params->report_pass_time),
      devinfo(compiler->devinfo), nir(shader),
      mem_ctx(params->mem_ctx),
      cfg(NULL), stage(shader->info.stage),
@@ -386,6 +389,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
      key(key), gs_compile(NULL), prog_data(prog_data),
      live_analysis(this), regpressure_analysis(this),
      performance_analysis(this), idom_analysis(this), def_analysis(this),
+     footprint_analysis(this),
      needs_register_pressure(needs_register_pressure),
      dispatch_width(dispatch_width),
      max_polygons(0),
@@ -403,6 +407,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
                        bool needs_register_pressure,
                        bool debug_enabled)
    : compiler(compiler), log_data(params->log_data),
+     report_pass_time(params->report_pass_time),
      devinfo(compiler->devinfo), nir(shader),
      mem_ctx(params->mem_ctx),
      cfg(NULL), stage(shader->info.stage),
@@ -410,6 +415,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
      key(&key->base), gs_compile(NULL), prog_data(&prog_data->base),
      live_analysis(this), regpressure_analysis(this),
      performance_analysis(this), idom_analysis(this), def_analysis(this),
+     footprint_analysis(this),
      needs_register_pressure(needs_register_pressure),
      dispatch_width(dispatch_width),
      max_polygons(max_polygons),
@@ -430,6 +436,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
                        bool needs_register_pressure,
                        bool debug_enabled)
    : compiler(compiler), log_data(params->log_data),
+     report_pass_time(params->report_pass_time),
      devinfo(compiler->devinfo), nir(shader),
      mem_ctx(params->mem_ctx),
      cfg(NULL), stage(shader->info.stage),
@@ -438,6 +445,7 @@ fs_visitor::fs_visitor(const struct brw_compiler *compiler,
      prog_data(&prog_data->base.base),
      live_analysis(this), regpressure_analysis(this),
      performance_analysis(this), idom_analysis(this), def_analysis(this),
+     footprint_analysis(this),
      needs_register_pressure(needs_register_pressure),
      dispatch_width(compiler->devinfo->ver >= 20 ? 16 : 8),
      max_polygons(0),
@@ -454,6 +462,10 @@ void
 fs_visitor::init()
 {
    this->max_dispatch_width = 32;
+   this->pre_ra_throughput = 0;
+   this->pre_ra_pressure = 0;
+   this->simd32_min_throughput = 0;
+   this->simd32_early_out = NULL;
 
    this->failed = false;
    this->fail_msg = NULL;
@@ -472,6 +484,8 @@ fs_visitor::init()
    this->spilled_any_registers = false;
 
    this->phase = BRW_SHADER_PHASE_INITIAL;
+   this->phase_start_time =
+      this->report_pass_time ? os_time_get_nano() : 0;
 }
 
 fs_visitor::~fs_visitor()
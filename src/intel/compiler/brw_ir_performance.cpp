@@ -80,25 +80,44 @@ namespace {
       EU_DEPENDENCY_ID_SBID_WR0 = EU_DEPENDENCY_ID_FLAG0 + 8,
       /* SBID token read completion.  Only used on Gfx12+. */
       EU_DEPENDENCY_ID_SBID_RD0 = EU_DEPENDENCY_ID_SBID_WR0 + 32,
-      /* Number of computation dependencies currently tracked. */
-      EU_NUM_DEPENDENCY_IDS = EU_DEPENDENCY_ID_SBID_RD0 + 32
+      /* Virtual register, one ID per GRF of the VGRF space.  Only used
+       * before register allocation.  Last because the number of IDs depends
+       * on the shader.
+       */
+      EU_DEPENDENCY_ID_VGRF0 = EU_DEPENDENCY_ID_SBID_RD0 + 32,
+      /* Computation result not tracked. */
+      EU_DEPENDENCY_ID_NONE = ~0u
    };
 
    /**
     * State of our modeling of the program execution.
     */
    struct state {
-      state() : unit_ready(), dep_ready(), unit_busy(), weight(1.0) {}
+      state(unsigned num_vgrf_regs) :
+         unit_ready(), num_dep_ids(EU_DEPENDENCY_ID_VGRF0 + num_vgrf_regs),
+         dep_ready(new unsigned[num_dep_ids]()), unit_busy(), weight(1.0) {}
+
+      ~state()
+      {
+         delete[] dep_ready;
+      }
+
       /**
        * Time at which a given unit will be ready to execute the next
        * computation, in clock units.
        */
       unsigned unit_ready[EU_NUM_UNITS];
+      /**
+       * Number of dependency IDs tracked, including one per register of the
+       * VGRF space so that virtual registers don't alias each other before
+       * register allocation.
+       */
+      unsigned num_dep_ids;
       /**
        * Time at which an instruction dependent on a given dependency ID will
        * be ready to execute, in clock units.
        */
-      unsigned dep_ready[EU_NUM_DEPENDENCY_IDS];
+      unsigned *dep_ready;
       /**
        * Aggregated utilization of a given unit excluding idle cycles,
        * in clock units.
@@ -715,7 +734,7 @@ namespace {
    void
    stall_on_dependency(state &st, enum intel_eu_dependency_id id)
    {
-      if (id < ARRAY_SIZE(st.dep_ready))
+      if (id < st.num_dep_ids)
          st.unit_ready[EU_UNIT_FE] = MAX2(st.unit_ready[EU_UNIT_FE],
                                        st.dep_ready[id]);
    }
@@ -754,7 +773,7 @@ namespace {
    mark_read_dependency(state &st, const perf_desc &perf,
                         enum intel_eu_dependency_id id)
    {
-      if (id < ARRAY_SIZE(st.dep_ready))
+      if (id < st.num_dep_ids)
          st.dep_ready[id] = st.unit_ready[EU_UNIT_FE] + perf.ls;
    }
 
@@ -770,18 +789,26 @@ namespace {
          st.dep_ready[id] = st.unit_ready[EU_UNIT_FE] + perf.la;
       else if (id >= EU_DEPENDENCY_ID_FLAG0 && id < EU_DEPENDENCY_ID_SBID_WR0)
          st.dep_ready[id] = st.unit_ready[EU_UNIT_FE] + perf.lf;
-      else if (id < ARRAY_SIZE(st.dep_ready))
+      else if (id < st.num_dep_ids)
          st.dep_ready[id] = st.unit_ready[EU_UNIT_FE] + perf.ld;
    }
 
    /**
     * Return the dependency ID of a backend_reg, offset by \p delta GRFs.
+    * \p vgrf_offsets gives the offset of every VGRF in the VGRF space before
+    * register allocation, and is NULL afterwards, when VGRF numbers have
+    * been replaced by GRF numbers.
     */
    enum intel_eu_dependency_id
-   reg_dependency_id(const intel_device_info *devinfo, const brw_reg &r,
+   reg_dependency_id(const intel_device_info *devinfo,
+                     const unsigned *vgrf_offsets, const brw_reg &r,
                      const int delta)
    {
-      if (r.file == VGRF) {
+      if (r.file == VGRF && vgrf_offsets) {
+         const unsigned i = vgrf_offsets[r.nr] + r.offset / REG_SIZE + delta;
+         return intel_eu_dependency_id(EU_DEPENDENCY_ID_VGRF0 + i);
+
+      } else if (r.file == VGRF) {
          const unsigned i = r.nr + r.offset / REG_SIZE + delta;
          assert(i < EU_DEPENDENCY_ID_ADDR0 - EU_DEPENDENCY_ID_GRF0);
          return intel_eu_dependency_id(EU_DEPENDENCY_ID_GRF0 + i);
@@ -803,7 +830,7 @@ namespace {
          return intel_eu_dependency_id(EU_DEPENDENCY_ID_ACCUM0 + i);
 
       } else {
-         return EU_NUM_DEPENDENCY_IDS;
+         return EU_DEPENDENCY_ID_NONE;
       }
    }
 
@@ -826,10 +853,10 @@ namespace {
    {
       if (swsb.mode) {
          assert(swsb.sbid <
-                EU_NUM_DEPENDENCY_IDS - EU_DEPENDENCY_ID_SBID_RD0);
+                EU_DEPENDENCY_ID_VGRF0 - EU_DEPENDENCY_ID_SBID_RD0);
          return intel_eu_dependency_id(EU_DEPENDENCY_ID_SBID_RD0 + swsb.sbid);
       } else {
-         return EU_NUM_DEPENDENCY_IDS;
+         return EU_DEPENDENCY_ID_NONE;
       }
    }
 
@@ -845,7 +872,7 @@ namespace {
                 EU_DEPENDENCY_ID_SBID_RD0 - EU_DEPENDENCY_ID_SBID_WR0);
          return intel_eu_dependency_id(EU_DEPENDENCY_ID_SBID_WR0 + swsb.sbid);
       } else {
-         return EU_NUM_DEPENDENCY_IDS;
+         return EU_DEPENDENCY_ID_NONE;
       }
    }
 
@@ -870,7 +897,7 @@ namespace {
     */
    void
    issue_inst(state &st, const struct brw_isa_info *isa,
-              const fs_inst *inst)
+              const unsigned *vgrf_offsets, const fs_inst *inst)
    {
       const struct intel_device_info *devinfo = isa->devinfo;
       const instruction_info info(isa, inst);
@@ -880,7 +907,7 @@ namespace {
       for (unsigned i = 0; i < inst->sources; i++) {
          for (unsigned j = 0; j < regs_read(inst, i); j++)
             stall_on_dependency(
-               st, reg_dependency_id(devinfo, inst->src[i], j));
+               st, reg_dependency_id(devinfo, vgrf_offsets, inst->src[i], j));
       }
 
       if (inst->reads_accumulator_implicitly()) {
@@ -888,7 +915,7 @@ namespace {
               j <= accum_reg_of_channel(devinfo, inst, info.tx,
                                         inst->exec_size - 1); j++)
             stall_on_dependency(
-               st, reg_dependency_id(devinfo, brw_acc_reg(8), j));
+               st, reg_dependency_id(devinfo, vgrf_offsets, brw_acc_reg(8), j));
       }
 
       if (const unsigned mask = inst->flags_read(devinfo)) {
@@ -903,7 +930,7 @@ namespace {
          if (inst->dst.file != BAD_FILE && !inst->dst.is_null()) {
             for (unsigned j = 0; j < regs_written(inst); j++)
                stall_on_dependency(
-                  st, reg_dependency_id(devinfo, inst->dst, j));
+                  st, reg_dependency_id(devinfo, vgrf_offsets, inst->dst, j));
          }
 
          if (inst->writes_accumulator_implicitly(devinfo)) {
@@ -911,7 +938,7 @@ namespace {
                  j <= accum_reg_of_channel(devinfo, inst, info.tx,
                                            inst->exec_size - 1); j++)
                stall_on_dependency(
-                  st, reg_dependency_id(devinfo, brw_acc_reg(8), j));
+                  st, reg_dependency_id(devinfo, vgrf_offsets, brw_acc_reg(8), j));
          }
 
          if (const unsigned mask = inst->flags_written(devinfo)) {
@@ -937,7 +964,7 @@ namespace {
             if (inst->is_payload(i)) {
                for (unsigned j = 0; j < regs_read(inst, i); j++)
                   mark_read_dependency(
-                     st, perf, reg_dependency_id(devinfo, inst->src[i], j));
+                     st, perf, reg_dependency_id(devinfo, vgrf_offsets, inst->src[i], j));
             }
          }
       }
@@ -946,7 +973,7 @@ namespace {
       if (inst->dst.file != BAD_FILE && !inst->dst.is_null()) {
          for (unsigned j = 0; j < regs_written(inst); j++) {
             mark_write_dependency(st, perf,
-                                  reg_dependency_id(devinfo, inst->dst, j));
+                                  reg_dependency_id(devinfo, vgrf_offsets, inst->dst, j));
          }
       }
 
@@ -955,7 +982,7 @@ namespace {
               j <= accum_reg_of_channel(devinfo, inst, info.tx,
                                         inst->exec_size - 1); j++)
             mark_write_dependency(st, perf,
-                                  reg_dependency_id(devinfo, brw_acc_reg(8), j));
+                                  reg_dependency_id(devinfo, vgrf_offsets, brw_acc_reg(8), j));
       }
 
       if (const unsigned mask = inst->flags_written(devinfo)) {
@@ -1025,7 +1052,10 @@ namespace {
       const float loop_weight = 10;
       unsigned halt_count = 0;
       unsigned elapsed = 0;
-      state st;
+      /* Same test as brw_print_instructions_to_file() for whether RA is done. */
+      const bool allocated = s->grf_used != 0;
+      const unsigned *vgrf_offsets = allocated ? NULL : s->alloc.offsets;
+      state st(allocated ? 0 : s->alloc.total_size);
 
       foreach_block(block, s->cfg) {
          const unsigned elapsed0 = elapsed;
@@ -1033,7 +1063,7 @@ namespace {
          foreach_inst_in_block(fs_inst, inst, block) {
             const unsigned clock0 = st.unit_ready[EU_UNIT_FE];
 
-            issue_inst(st, &s->compiler->isa, inst);
+            issue_inst(st, &s->compiler->isa, vgrf_offsets, inst);
 
             if (inst->opcode == SHADER_OPCODE_HALT_TARGET && halt_count)
                st.weight /= discard_weight;
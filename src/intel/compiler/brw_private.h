@@ -38,6 +38,17 @@ void brw_fs_alloc_reg_sets(struct brw_compiler *compiler);
 extern const char *const conditional_modifier[16];
 extern const char *const pred_ctrl_align16[16];
 
+/* brw_simd_selection.cpp */
+void brw_simd_threads_init(struct brw_compiler *compiler);
+
+/* brw_capture.c */
+void brw_capture_compile(const struct brw_compiler *compiler,
+                         gl_shader_stage stage,
+                         const struct brw_compile_params *params,
+                         const void *key,
+                         const struct brw_stage_prog_data *prog_data,
+                         const struct brw_compile_fs_params *fs_params);
+
 #ifdef __cplusplus
 }
 #endif
@@ -62,6 +73,19 @@ struct brw_simd_selection_state {
 
    bool compiled[SIMD_COUNT];
    bool spilled[SIMD_COUNT];
+
+   /**
+    * Width picked for an earlier variant of the shader (see brw_simd_hint),
+    * or -1.  While set, no other width is compiled.
+    */
+   int hint = -1;
+   bool hint_spilled;
+
+   /** Whether the other widths were skipped because of the hint. */
+   bool hint_used;
+
+   /** Hinted width that didn't work out, not to be compiled again. */
+   int hint_missed = -1;
 };
 
 inline int brw_simd_first_compiled(const brw_simd_selection_state &state)
@@ -86,12 +110,60 @@ void brw_simd_mark_compiled(brw_simd_selection_state &state, unsigned simd, bool
 
 int brw_simd_select(const brw_simd_selection_state &state);
 
+/**
+ * Number of compiles a SIMD hint is used for before all the widths are
+ * tried again.
+ */
+#define BRW_SIMD_HINT_RETRY_INTERVAL 8
+
+bool brw_simd_hint_usable(const struct brw_simd_hint *hint);
+
+/**
+ * Store the outcome of a compile in the hint.  \p hint_used says whether
+ * the hint made it skip the widths wider than \p width, \p wider_lost
+ * whether those were tried and lost instead of being ruled out by the key.
+ */
+void brw_simd_update_hint(struct brw_simd_hint *hint, bool hint_used,
+                          unsigned width, bool spilled, bool wider_lost);
+
+void brw_simd_apply_hint(brw_simd_selection_state &state,
+                         const struct brw_simd_hint *hint);
+
+/**
+ * Called once the hinted width was tried.  Returns true if it didn't
+ * compile, or spilled unlike last time, in which case the hint is dropped
+ * and the caller should go through the other widths again.
+ */
+bool brw_simd_retry_without_hint(brw_simd_selection_state &state);
+
+void brw_simd_record_hint(const brw_simd_selection_state &state,
+                          int selected_simd, struct brw_simd_hint *hint);
+
 int brw_simd_select_for_workgroup_size(const struct intel_device_info *devinfo,
                                        const struct brw_cs_prog_data *prog_data,
                                        const unsigned *sizes);
 
 bool brw_should_print_shader(const nir_shader *shader, uint64_t debug_flag);
 
+/**
+ * Whether SIMD variants can be compiled concurrently on worker threads.
+ * Never the case when the shader is dumped, since the output of the
+ * variants would be interleaved.
+ */
+bool brw_simd_use_threads(const struct brw_compiler *compiler,
+                          bool debug_enabled);
+
+typedef void (*brw_simd_compile_func)(void *data, unsigned index);
+
+/**
+ * Calls func(data, i) for every i < count and waits for all of them.  Job 0
+ * runs on the calling thread, the others on worker threads if
+ * brw_simd_use_threads() allows it.
+ */
+void brw_simd_compile_parallel(const struct brw_compiler *compiler,
+                               unsigned count, brw_simd_compile_func func,
+                               void *data);
+
 #endif // __cplusplus
 
 #endif // BRW_PRIVATE_H
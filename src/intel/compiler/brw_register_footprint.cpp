@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "brw_fs.h"
+#include "brw_cfg.h"
+#include "brw_ir_analysis.h"
+
+/**
+ * Per-instruction register footprint of the program.
+ *
+ * Bank conflict mitigation, post-RA scheduling and scoreboard lowering all
+ * walk the program several times looking at which GRFs each instruction
+ * reads and writes.  This analysis calculates that once, as one range per
+ * operand: the destination first, followed by each source.
+ *
+ * Bank conflict mitigation renames registers, post-RA scheduling reorders
+ * instructions and brw_fs_lower_vgrfs_to_fixed_grfs() changes their file.
+ * Each of them patches the table instead of dropping it, so it is only
+ * calculated once per compile.
+ *
+ * Usage:
+ *
+ *    const register_footprint &fp = s.footprint_analysis.require();
+ *    const register_footprint::range &r = fp.src(ip, i);
+ *    if (r.is_grf()) {
+ *       for (unsigned j = 0; j < r.len; j++)
+ *          ... GRF r.start + j is read by source i of instruction ip ...
+ *    }
+ */
+
+using namespace brw;
+
+static register_footprint::range
+operand_range(const brw_reg &r, unsigned len)
+{
+   register_footprint::range range = {};
+   range.file = r.file;
+
+   if (range.is_grf()) {
+      range.start = (r.file == VGRF ? r.nr + r.offset / REG_SIZE :
+                     reg_offset(r) / REG_SIZE);
+      range.len = len;
+      assert(range.len == len);
+   }
+
+   return range;
+}
+
+register_footprint::register_footprint(const fs_visitor *v)
+{
+   num_insts = v->cfg->last_block()->end_ip + 1;
+   offsets = new unsigned[num_insts + 1];
+
+   unsigned num_ranges = 0;
+   unsigned ip = 0;
+
+   foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
+      offsets[ip++] = num_ranges;
+      num_ranges += 1 + inst->sources;
+   }
+
+   assert(ip == num_insts);
+   offsets[num_insts] = num_ranges;
+   ranges = new range[num_ranges];
+
+   ip = 0;
+
+   foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
+      range *r = &ranges[offsets[ip++]];
+
+      *r++ = operand_range(inst->dst, regs_written(inst));
+
+      for (unsigned i = 0; i < inst->sources; i++)
+         *r++ = operand_range(inst->src[i], regs_read(inst, i));
+   }
+}
+
+register_footprint::~register_footprint()
+{
+   delete[] offsets;
+   delete[] ranges;
+}
+
+/**
+ * Move the ranges along with the instructions after they were reordered.
+ * \p old_ips gives the IP each instruction had before.
+ */
+void
+register_footprint::reorder(const unsigned *old_ips)
+{
+   unsigned *new_offsets = new unsigned[num_insts + 1];
+   range *new_ranges = new range[offsets[num_insts]];
+   unsigned n = 0;
+
+   for (unsigned ip = 0; ip < num_insts; ip++) {
+      const unsigned old_ip = old_ips[ip];
+      const unsigned count = offsets[old_ip + 1] - offsets[old_ip];
+
+      new_offsets[ip] = n;
+      memcpy(&new_ranges[n], &ranges[offsets[old_ip]], count * sizeof(range));
+      n += count;
+   }
+
+   assert(n == offsets[num_insts]);
+   new_offsets[num_insts] = n;
+
+   delete[] offsets;
+   delete[] ranges;
+   offsets = new_offsets;
+   ranges = new_ranges;
+}
+
+/**
+ * Account for brw_fs_lower_vgrfs_to_fixed_grfs(), which turns allocated
+ * VGRFs into the same GRFs in the FIXED_GRF file.
+ */
+void
+register_footprint::lower_vgrfs_to_fixed_grfs()
+{
+   for (unsigned i = 0; i < offsets[num_insts]; i++) {
+      if (ranges[i].file == VGRF)
+         ranges[i].file = FIXED_GRF;
+   }
+}
+
+/**
+ * Check that the table still has the layout of the program: one entry per
+ * instruction and one range per operand.  Comparing the ranges themselves
+ * would mean recomputing the whole table on every require(), see equals()
+ * for that.
+ */
+bool
+register_footprint::validate(const fs_visitor *v) const
+{
+   unsigned ip = 0;
+
+   foreach_block_and_inst(block, fs_inst, inst, v->cfg) {
+      if (ip >= num_insts ||
+          offsets[ip + 1] - offsets[ip] != 1u + inst->sources)
+         return false;
+
+      ip++;
+   }
+
+   return ip == num_insts;
+}
+
+bool
+register_footprint::equals(const register_footprint &fp) const
+{
+   if (fp.num_insts != num_insts)
+      return false;
+
+   for (unsigned ip = 0; ip <= num_insts; ip++) {
+      if (fp.offsets[ip] != offsets[ip])
+         return false;
+   }
+
+   for (unsigned i = 0; i < offsets[num_insts]; i++) {
+      if (!(fp.ranges[i] == ranges[i]))
+         return false;
+   }
+
+   return true;
+}
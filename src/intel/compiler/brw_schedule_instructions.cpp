@@ -632,6 +632,18 @@ public:
    int grf_count;
    const fs_visitor *s;
 
+   /**
+    * GRFs accessed by each instruction, only used after register allocation
+    * when VGRF and FIXED_GRF references share the same register space.
+    */
+   const register_footprint *footprint;
+
+   /**
+    * IP before scheduling of the instruction now at each IP, used to keep
+    * the register footprint up to date after register allocation.
+    */
+   unsigned *old_ips;
+
    /**
     * Last instruction to have written the grf (or a channel in the grf, for the
     * scalar backend)
@@ -763,6 +775,10 @@ instruction_scheduler::instruction_scheduler(void *mem_ctx, const fs_visitor *s,
       this->hw_reads_remaining = NULL;
    }
 
+   this->footprint = post_reg_alloc ? &s->footprint_analysis.require() : NULL;
+   this->old_ips = post_reg_alloc ?
+      linear_alloc_array(lin_ctx, unsigned, nodes_len) : NULL;
+
    foreach_block(block, s->cfg) {
       set_current_block(block);
 
@@ -1201,6 +1217,7 @@ instruction_scheduler::calculate_deps()
    /* top-to-bottom dependencies: RAW and WAW. */
    for (schedule_node *n = current.start; n < current.end; n++) {
       fs_inst *inst = (fs_inst *)n->inst;
+      const unsigned ip = n - nodes;
 
       if (is_scheduling_barrier(inst))
          add_barrier_deps(n);
@@ -1211,16 +1228,15 @@ instruction_scheduler::calculate_deps()
 
       /* read-after-write deps. */
       for (int i = 0; i < inst->sources; i++) {
-         if (inst->src[i].file == VGRF) {
+         if (post_reg_alloc && footprint->src(ip, i).is_grf()) {
+            const register_footprint::range &src = footprint->src(ip, i);
+            for (unsigned r = 0; r < src.len; r++)
+               add_dep(last_grf_write[src.start + r], n);
+         } else if (inst->src[i].file == VGRF) {
             for (unsigned r = 0; r < regs_read(inst, i); r++)
                add_dep(last_grf_write[grf_index(inst->src[i]) + r], n);
          } else if (inst->src[i].file == FIXED_GRF) {
-            if (post_reg_alloc) {
-               for (unsigned r = 0; r < regs_read(inst, i); r++)
-                  add_dep(last_grf_write[inst->src[i].nr + r], n);
-            } else {
-               add_dep(last_fixed_grf_write, n);
-            }
+            add_dep(last_fixed_grf_write, n);
          } else if (inst->src[i].is_accumulator()) {
             add_dep(last_accumulator_write, n);
          } else if (register_needs_barrier(inst->src[i])) {
@@ -1243,22 +1259,21 @@ instruction_scheduler::calculate_deps()
       }
 
       /* write-after-write deps. */
-      if (inst->dst.file == VGRF) {
+      if (post_reg_alloc && footprint->dst(ip).is_grf()) {
+         const register_footprint::range &dst = footprint->dst(ip);
+         for (unsigned r = 0; r < dst.len; r++) {
+            add_dep(last_grf_write[dst.start + r], n);
+            last_grf_write[dst.start + r] = n;
+         }
+      } else if (inst->dst.file == VGRF) {
          int grf_idx = grf_index(inst->dst);
          for (unsigned r = 0; r < regs_written(inst); r++) {
             add_dep(last_grf_write[grf_idx + r], n);
             last_grf_write[grf_idx + r] = n;
          }
       } else if (inst->dst.file == FIXED_GRF) {
-         if (post_reg_alloc) {
-            for (unsigned r = 0; r < regs_written(inst); r++) {
-               add_dep(last_grf_write[inst->dst.nr + r], n);
-               last_grf_write[inst->dst.nr + r] = n;
-            }
-         } else {
-            add_dep(last_fixed_grf_write, n);
-            last_fixed_grf_write = n;
-         }
+         add_dep(last_fixed_grf_write, n);
+         last_fixed_grf_write = n;
       } else if (inst->dst.is_accumulator()) {
          add_dep(last_accumulator_write, n);
          last_accumulator_write = n;
@@ -1293,19 +1308,19 @@ instruction_scheduler::calculate_deps()
 
    for (schedule_node *n = current.end - 1; n >= current.start; n--) {
       fs_inst *inst = (fs_inst *)n->inst;
+      const unsigned ip = n - nodes;
 
       /* write-after-read deps. */
       for (int i = 0; i < inst->sources; i++) {
-         if (inst->src[i].file == VGRF) {
+         if (post_reg_alloc && footprint->src(ip, i).is_grf()) {
+            const register_footprint::range &src = footprint->src(ip, i);
+            for (unsigned r = 0; r < src.len; r++)
+               add_dep(n, last_grf_write[src.start + r], 0);
+         } else if (inst->src[i].file == VGRF) {
             for (unsigned r = 0; r < regs_read(inst, i); r++)
                add_dep(n, last_grf_write[grf_index(inst->src[i]) + r], 0);
          } else if (inst->src[i].file == FIXED_GRF) {
-            if (post_reg_alloc) {
-               for (unsigned r = 0; r < regs_read(inst, i); r++)
-                  add_dep(n, last_grf_write[inst->src[i].nr + r], 0);
-            } else {
-               add_dep(n, last_fixed_grf_write, 0);
-            }
+            add_dep(n, last_fixed_grf_write, 0);
          } else if (inst->src[i].is_accumulator()) {
             add_dep(n, last_accumulator_write, 0);
          } else if (register_needs_barrier(inst->src[i])) {
@@ -1329,16 +1344,15 @@ instruction_scheduler::calculate_deps()
       /* Update the things this instruction wrote, so earlier reads
        * can mark this as WAR dependency.
        */
-      if (inst->dst.file == VGRF) {
+      if (post_reg_alloc && footprint->dst(ip).is_grf()) {
+         const register_footprint::range &dst = footprint->dst(ip);
+         for (unsigned r = 0; r < dst.len; r++)
+            last_grf_write[dst.start + r] = n;
+      } else if (inst->dst.file == VGRF) {
          for (unsigned r = 0; r < regs_written(inst); r++)
             last_grf_write[grf_index(inst->dst) + r] = n;
       } else if (inst->dst.file == FIXED_GRF) {
-         if (post_reg_alloc) {
-            for (unsigned r = 0; r < regs_written(inst); r++)
-               last_grf_write[inst->dst.nr + r] = n;
-         } else {
-            last_fixed_grf_write = n;
-         }
+         last_fixed_grf_write = n;
       } else if (inst->dst.is_accumulator()) {
          last_accumulator_write = n;
       } else if (register_needs_barrier(inst->dst)) {
@@ -1488,6 +1502,9 @@ instruction_scheduler::schedule(schedule_node *chosen)
    chosen->remove();
    current.block->instructions.push_tail(chosen->inst);
 
+   if (old_ips)
+      old_ips[current.block->start_ip + current.scheduled - 1] = chosen - nodes;
+
    /* If we expected a delay for scheduling, then bump the clock to reflect
     * that.  In reality, the hardware will switch to another hyperthread
     * and may not return to dispatching our thread for a while even after
@@ -1634,12 +1651,16 @@ brw_schedule_instructions_post_ra(fs_visitor &s)
    const int grf_count = reg_unit(s.devinfo) * s.grf_used;
 
    void *mem_ctx = ralloc_context(NULL);
+   register_footprint &fp = s.footprint_analysis.require();
 
    instruction_scheduler sched(mem_ctx, &s, grf_count, s.first_non_payload_grf,
                                s.cfg->num_blocks, post_reg_alloc);
    sched.run(SCHEDULE_POST);
 
+   fp.reorder(sched.old_ips);
+   assert(fp.equals(register_footprint(&s)));
+
    ralloc_free(mem_ctx);
 
-   s.invalidate_analysis(DEPENDENCY_INSTRUCTIONS);
+   s.invalidate_analysis(DEPENDENCY_INSTRUCTIONS, KEEP_REGISTER_FOOTPRINT);
 }
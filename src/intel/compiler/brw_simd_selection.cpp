@@ -26,6 +26,9 @@
 #include "intel/dev/intel_debug.h"
 #include "intel/dev/intel_device_info.h"
 #include "util/ralloc.h"
+#include "util/u_call_once.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 
 unsigned
 brw_required_dispatch_width(const struct shader_info *info)
@@ -82,8 +85,19 @@ bool
 brw_simd_should_compile(brw_simd_selection_state &state, unsigned simd)
 {
    assert(simd < SIMD_COUNT);
+
+   /* Already tried because of the hint, error[] says why it wasn't kept. */
+   if ((int)simd == state.hint_missed)
+      return false;
+
    assert(!state.compiled[simd]);
 
+   if (state.hint >= 0 && (int)simd != state.hint) {
+      state.error[simd] = "Skipped, a different width was picked for "
+                          "another variant of the shader";
+      return false;
+   }
+
    const auto cs_prog_data = get_cs_prog_data(state);
    const auto prog_data = get_prog_data(state);
    const unsigned width = 8u << simd;
@@ -213,6 +227,91 @@ brw_simd_mark_compiled(brw_simd_selection_state &state, unsigned simd, bool spil
    }
 }
 
+bool
+brw_simd_hint_usable(const struct brw_simd_hint *hint)
+{
+   return hint && hint->dispatch_width &&
+          hint->skipped < BRW_SIMD_HINT_RETRY_INTERVAL;
+}
+
+void
+brw_simd_update_hint(struct brw_simd_hint *hint, bool hint_used,
+                     unsigned width, bool spilled, bool wider_lost)
+{
+   if (!hint)
+      return;
+
+   hint->skipped = hint_used ? hint->skipped + 1 : 0;
+
+   /* Keep the widest width seen so far unless the wider ones lost, so that
+    * a variant limited by its key doesn't hold back all the other ones.
+    */
+   if (wider_lost || width >= hint->dispatch_width) {
+      hint->dispatch_width = width;
+      hint->spilled = spilled;
+   }
+}
+
+void
+brw_simd_apply_hint(brw_simd_selection_state &state,
+                    const struct brw_simd_hint *hint)
+{
+   if (!brw_simd_hint_usable(hint) || state.required_width)
+      return;
+
+   /* With a variable workgroup size all the widths are needed, the choice
+    * happens at dispatch time.
+    */
+   const auto cs_prog_data = get_cs_prog_data(state);
+   if (cs_prog_data && cs_prog_data->local_size[0] == 0)
+      return;
+
+   const int simd = util_logbase2(hint->dispatch_width) - 3;
+   if (simd < 0 || simd >= SIMD_COUNT)
+      return;
+
+   state.hint = simd;
+   state.hint_spilled = hint->spilled;
+   state.hint_used = true;
+}
+
+bool
+brw_simd_retry_without_hint(brw_simd_selection_state &state)
+{
+   if (state.hint < 0)
+      return false;
+
+   const int simd = state.hint;
+   state.hint = -1;
+
+   if (state.compiled[simd] && state.spilled[simd] == state.hint_spilled)
+      return false;
+
+   /* The errors were only about the hint. */
+   for (int i = 0; i < SIMD_COUNT; i++) {
+      if (i != simd)
+         state.error[i] = NULL;
+   }
+
+   state.hint_missed = simd;
+   state.hint_used = false;
+   return true;
+}
+
+void
+brw_simd_record_hint(const brw_simd_selection_state &state,
+                     int selected_simd, struct brw_simd_hint *hint)
+{
+   if (selected_simd < 0)
+      return;
+
+   /* Without the hint, the widths that weren't picked were all tried or
+    * ruled out by the shader itself.
+    */
+   brw_simd_update_hint(hint, state.hint_used, 8u << selected_simd,
+                        state.spilled[selected_simd], !state.hint_used);
+}
+
 int
 brw_simd_select(const struct brw_simd_selection_state &state)
 {
@@ -274,3 +373,113 @@ brw_simd_select_for_workgroup_size(const struct intel_device_info *devinfo,
 
    return brw_simd_select(simd_state);
 }
+
+struct brw_simd_threads {
+   struct util_queue queue;
+   util_once_flag once;
+   bool ready;
+};
+
+static void
+simd_threads_start(const void *data)
+{
+   struct brw_simd_threads *threads = (struct brw_simd_threads *)data;
+
+   const unsigned num_cpus = util_get_cpu_caps()->nr_cpus;
+   if (num_cpus < 2)
+      return;
+
+   /* The compiling thread always runs one of the variants itself, so a
+    * single compile never has more than SIMD_COUNT - 1 jobs in flight.
+    * Drivers already compile several shaders at once on their own threads,
+    * those share these workers instead of each getting a CPU's worth more.
+    */
+   const unsigned num_threads = MIN2(num_cpus - 1, SIMD_COUNT - 1);
+
+   threads->ready = util_queue_init(&threads->queue, "brw_simd",
+                                    num_threads * SIMD_COUNT, num_threads,
+                                    UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL);
+}
+
+static void
+simd_threads_destroy(void *data)
+{
+   struct brw_simd_threads *threads = (struct brw_simd_threads *)data;
+
+   if (threads->ready)
+      util_queue_destroy(&threads->queue);
+}
+
+void
+brw_simd_threads_init(struct brw_compiler *compiler)
+{
+   struct brw_simd_threads *threads =
+      rzalloc(compiler, struct brw_simd_threads);
+   const util_once_flag once = UTIL_ONCE_FLAG_INIT;
+
+   threads->once = once;
+   ralloc_set_destructor(threads, simd_threads_destroy);
+
+   compiler->simd_threads = threads;
+}
+
+bool
+brw_simd_use_threads(const struct brw_compiler *compiler, bool debug_enabled)
+{
+   if (debug_enabled || INTEL_DEBUG(DEBUG_NO_SIMD_THREADS))
+      return false;
+
+   struct brw_simd_threads *threads = compiler->simd_threads;
+
+   util_call_once_data(&threads->once, simd_threads_start, threads);
+   return threads->ready;
+}
+
+struct simd_compile_job {
+   struct util_queue_fence fence;
+   brw_simd_compile_func func;
+   void *data;
+   unsigned index;
+};
+
+static void
+simd_compile_job_execute(void *job, void *gdata, int thread_index)
+{
+   struct simd_compile_job *compile_job = (struct simd_compile_job *)job;
+
+   compile_job->func(compile_job->data, compile_job->index);
+}
+
+void
+brw_simd_compile_parallel(const struct brw_compiler *compiler,
+                          unsigned count, brw_simd_compile_func func,
+                          void *data)
+{
+   assert(count <= SIMD_COUNT);
+
+   if (count < 2 || !brw_simd_use_threads(compiler, false)) {
+      for (unsigned i = 0; i < count; i++)
+         func(data, i);
+      return;
+   }
+
+   struct simd_compile_job jobs[SIMD_COUNT - 1];
+
+   for (unsigned i = 1; i < count; i++) {
+      struct simd_compile_job *job = &jobs[i - 1];
+
+      job->func = func;
+      job->data = data;
+      job->index = i;
+      util_queue_fence_init(&job->fence);
+      util_queue_add_job(&compiler->simd_threads->queue, job, &job->fence,
+                         simd_compile_job_execute, NULL, 0);
+   }
+
+   func(data, 0);
+
+   for (unsigned i = 1; i < count; i++) {
+      util_queue_fence_wait(&jobs[i - 1].fence);
+      util_queue_fence_destroy(&jobs[i - 1].fence);
+   }
+}
@@ -23,6 +23,9 @@
 
 
 #include "brw_private.h"
+#include "brw_nir.h"
+#include "compiler/glsl_types.h"
+#include "compiler/nir/nir_builder.h"
 #include "compiler/shader_info.h"
 #include "intel/dev/intel_debug.h"
 #include "intel/dev/intel_device_info.h"
@@ -396,3 +399,270 @@ TEST_F(SIMDSelectionCS, FirstCompiledIsSIMD32)
    ASSERT_TRUE(brw_simd_any_compiled(simd_state));
    ASSERT_EQ(brw_simd_first_compiled(simd_state), SIMD32);
 }
+
+TEST_F(SIMDSelectionCS, HintOnlyCompilesHintedWidth)
+{
+   const struct brw_simd_hint hint = { .dispatch_width = 16 };
+   brw_simd_apply_hint(simd_state, &hint);
+
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD8));
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD16));
+   brw_simd_mark_compiled(simd_state, SIMD16, not_spilled);
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD32));
+
+   ASSERT_FALSE(brw_simd_retry_without_hint(simd_state));
+   ASSERT_EQ(brw_simd_select(simd_state), SIMD16);
+}
+
+TEST_F(SIMDSelectionCS, HintFallsBackWhenHintedWidthFails)
+{
+   const struct brw_simd_hint hint = { .dispatch_width = 16 };
+   brw_simd_apply_hint(simd_state, &hint);
+
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD8));
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD16));
+   simd_state.error[SIMD16] = "failed";
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD32));
+
+   ASSERT_TRUE(brw_simd_retry_without_hint(simd_state));
+
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD8));
+   brw_simd_mark_compiled(simd_state, SIMD8, not_spilled);
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD16));
+   ASSERT_STREQ(simd_state.error[SIMD16], "failed");
+
+   ASSERT_FALSE(brw_simd_retry_without_hint(simd_state));
+   ASSERT_EQ(brw_simd_select(simd_state), SIMD8);
+}
+
+TEST_F(SIMDSelectionCS, HintFallsBackWhenHintedWidthNowSpills)
+{
+   const struct brw_simd_hint hint = { .dispatch_width = 16 };
+   brw_simd_apply_hint(simd_state, &hint);
+
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD16));
+   brw_simd_mark_compiled(simd_state, SIMD16, spilled);
+
+   ASSERT_TRUE(brw_simd_retry_without_hint(simd_state));
+
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD8));
+   brw_simd_mark_compiled(simd_state, SIMD8, not_spilled);
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD16));
+   ASSERT_FALSE(brw_simd_should_compile(simd_state, SIMD32));
+
+   ASSERT_EQ(brw_simd_select(simd_state), SIMD8);
+}
+
+TEST_F(SIMDSelectionCS, HintIgnoredForVariableWorkgroupSize)
+{
+   prog_data->local_size[0] = 0;
+   prog_data->local_size[1] = 0;
+   prog_data->local_size[2] = 0;
+
+   const struct brw_simd_hint hint = { .dispatch_width = 16 };
+   brw_simd_apply_hint(simd_state, &hint);
+
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD8));
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD16));
+}
+
+TEST_F(SIMDSelectionCS, RecordHint)
+{
+   struct brw_simd_hint hint = {};
+
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD8));
+   brw_simd_mark_compiled(simd_state, SIMD8, spilled);
+
+   brw_simd_record_hint(simd_state, brw_simd_select(simd_state), &hint);
+   ASSERT_EQ(hint.dispatch_width, 8);
+   ASSERT_TRUE(hint.spilled);
+}
+
+TEST_F(SIMDSelectionCS, HintRetriedPeriodically)
+{
+   struct brw_simd_hint hint = { .dispatch_width = 8 };
+
+   for (unsigned i = 0; i < BRW_SIMD_HINT_RETRY_INTERVAL; i++) {
+      brw_simd_selection_state state = {
+         .devinfo = devinfo,
+         .prog_data = prog_data,
+      };
+      brw_simd_apply_hint(state, &hint);
+      ASSERT_FALSE(brw_simd_should_compile(state, SIMD16));
+      ASSERT_TRUE(brw_simd_should_compile(state, SIMD8));
+      brw_simd_mark_compiled(state, SIMD8, not_spilled);
+      ASSERT_FALSE(brw_simd_retry_without_hint(state));
+      brw_simd_record_hint(state, brw_simd_select(state), &hint);
+   }
+
+   ASSERT_EQ(hint.skipped, BRW_SIMD_HINT_RETRY_INTERVAL);
+
+   brw_simd_apply_hint(simd_state, &hint);
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD8));
+   brw_simd_mark_compiled(simd_state, SIMD8, not_spilled);
+   ASSERT_TRUE(brw_simd_should_compile(simd_state, SIMD16));
+   brw_simd_mark_compiled(simd_state, SIMD16, not_spilled);
+
+   brw_simd_record_hint(simd_state, brw_simd_select(simd_state), &hint);
+   ASSERT_EQ(hint.dispatch_width, 16);
+   ASSERT_EQ(hint.skipped, 0);
+}
+
+static void
+fs_log(void *, unsigned *, const char *, ...)
+{
+}
+
+class SIMDSelectionFS : public ::testing::Test {
+protected:
+   void SetUp() override
+   {
+      mem_ctx = ralloc_context(NULL);
+      devinfo = rzalloc(mem_ctx, intel_device_info);
+
+      process_intel_debug_variable();
+      glsl_type_singleton_init_or_ref();
+
+      /* The compute shader tests leave INTEL_DEBUG=do32 set, which disables
+       * the hint.
+       */
+      saved_intel_debug = intel_debug;
+      saved_intel_simd = intel_simd;
+      intel_debug &= ~DEBUG_DO32;
+
+      /* Tigerlake, where all three widths are compiled without a hint. */
+      intel_get_device_info_from_pci_id(0x9a49, devinfo);
+      compiler = brw_compiler_create(mem_ctx, devinfo);
+      compiler->shader_debug_log = fs_log;
+      compiler->shader_perf_log = fs_log;
+   }
+
+   void TearDown() override
+   {
+      intel_debug = saved_intel_debug;
+      intel_simd = saved_intel_simd;
+
+      ralloc_free(mem_ctx);
+      glsl_type_singleton_decref();
+   }
+
+   /* Compiles a fragment shader, returns the widest width that was kept. */
+   unsigned compile(const brw_wm_prog_key &key, brw_simd_hint *hint)
+   {
+      nir_builder b = nir_builder_init_simple_shader(
+         MESA_SHADER_FRAGMENT, compiler->nir_options[MESA_SHADER_FRAGMENT],
+         "simd_hint");
+      nir_variable *in = nir_variable_create(b.shader, nir_var_shader_in,
+                                             glsl_vec4_type(), "in");
+      in->data.location = VARYING_SLOT_VAR0;
+      nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                              glsl_vec4_type(), "out");
+      out->data.location = FRAG_RESULT_DATA0;
+      /* Dependent texture fetches, latency bound enough for SIMD32 to win. */
+      nir_def *v = nir_load_var(&b, in);
+      for (unsigned i = 0; i < 4; i++) {
+         nir_tex_instr *tex = nir_tex_instr_create(b.shader, 1);
+         tex->op = nir_texop_tex;
+         tex->sampler_dim = GLSL_SAMPLER_DIM_2D;
+         tex->dest_type = nir_type_float32;
+         tex->coord_components = 2;
+         tex->src[0] = nir_tex_src_for_ssa(nir_tex_src_coord,
+                                           nir_channels(&b, v, 0x3));
+         nir_def_init(&tex->instr, &tex->def, 4, 32);
+         nir_builder_instr_insert(&b, &tex->instr);
+         v = &tex->def;
+      }
+      nir_store_var(&b, out, v, 0xf);
+      b.shader->info.inputs_read = VARYING_BIT_VAR(0);
+      b.shader->info.outputs_written = BITFIELD64_BIT(FRAG_RESULT_DATA0);
+      BITSET_SET(b.shader->info.textures_used, 0);
+      ralloc_steal(mem_ctx, b.shader);
+
+      struct brw_nir_compiler_opts opts = {};
+      brw_preprocess_nir(compiler, b.shader, &opts);
+
+      struct brw_wm_prog_data prog_data = {};
+      struct brw_compile_fs_params params = {
+         .base = {
+            .mem_ctx = mem_ctx,
+            .nir = b.shader,
+            .simd_hint = hint,
+         },
+         .key = &key,
+         .prog_data = &prog_data,
+         .max_polygons = 1,
+      };
+
+      EXPECT_NE(brw_compile_fs(compiler, &params), nullptr);
+      return prog_data.dispatch_32 ? 32 : prog_data.dispatch_16 ? 16 : 8;
+   }
+
+   void *mem_ctx;
+   intel_device_info *devinfo;
+   struct brw_compiler *compiler;
+   uint64_t saved_intel_debug;
+   uint64_t saved_intel_simd;
+};
+
+/* Which width wins an unhinted compile is up to the performance estimates,
+ * so the tests below start from explicit hints and only check the widths
+ * that the hint allows.
+ */
+TEST_F(SIMDSelectionFS, HintSkipsWiderWidths)
+{
+   const brw_wm_prog_key key = { .nr_color_regions = 1 };
+   struct brw_simd_hint hint = { .dispatch_width = 16 };
+
+   ASSERT_EQ(compile(key, &hint), 16);
+   ASSERT_EQ(hint.dispatch_width, 16);
+   ASSERT_EQ(hint.skipped, 1);
+
+   hint.dispatch_width = 8;
+   ASSERT_EQ(compile(key, &hint), 8);
+   ASSERT_EQ(hint.dispatch_width, 8);
+   ASSERT_EQ(hint.skipped, 2);
+}
+
+TEST_F(SIMDSelectionFS, LimitedVariantKeepsHint)
+{
+   brw_wm_prog_key key = { .nr_color_regions = 1 };
+   struct brw_simd_hint hint = { .dispatch_width = 32 };
+
+   /* SIMD32 isn't supported with coarse pixel shading. */
+   key.coarse_pixel = true;
+   ASSERT_EQ(compile(key, &hint), 16);
+   ASSERT_EQ(hint.dispatch_width, 32);
+   ASSERT_EQ(hint.skipped, 0);
+}
+
+TEST_F(SIMDSelectionFS, HintRetriedPeriodically)
+{
+   const brw_wm_prog_key key = { .nr_color_regions = 1 };
+   struct brw_simd_hint hint = { .dispatch_width = 16 };
+
+   for (unsigned i = 0; i < BRW_SIMD_HINT_RETRY_INTERVAL; i++) {
+      ASSERT_EQ(compile(key, &hint), 16);
+      ASSERT_EQ(hint.skipped, i + 1);
+   }
+
+   /* Without the hint, the width that wins is recorded as the new hint. */
+   const unsigned width = compile(key, &hint);
+   ASSERT_EQ(hint.dispatch_width, width);
+   ASSERT_EQ(hint.skipped, 0);
+}
+
+TEST_F(SIMDSelectionFS, UnhintedCompileRecordsHint)
+{
+   const brw_wm_prog_key key = { .nr_color_regions = 1 };
+   struct brw_simd_hint hint = {};
+
+   const unsigned width = compile(key, &hint);
+   ASSERT_EQ(hint.dispatch_width, width);
+   ASSERT_EQ(hint.skipped, 0);
+
+   /* With only SIMD32 enabled, it's kept whatever the estimates say. */
+   intel_simd &= ~(DEBUG_FS_SIMD8 | DEBUG_FS_SIMD16);
+   hint = {};
+   ASSERT_EQ(compile(key, &hint), 32);
+   ASSERT_EQ(hint.dispatch_width, 32);
+}
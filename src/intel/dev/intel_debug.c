@@ -108,6 +108,7 @@ static const struct debug_control debug_control[] = {
    { "reg-pressure", DEBUG_REG_PRESSURE },
    { "shader-print", DEBUG_SHADER_PRINT },
    { "cl-quiet",     DEBUG_CL_QUIET },
+   { "no-simd-threads", DEBUG_NO_SIMD_THREADS },
    { NULL,    0 }
 };
 
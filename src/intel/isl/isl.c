@@ -28,7 +28,9 @@
 
 #include "dev/intel_debug.h"
 #include "genxml/genX_bits.h"
+#include "util/hash_table.h"
 #include "util/log.h"
+#include "util/u_atomic.h"
 #include "util/u_math.h"
 
 #include "isl.h"
@@ -312,6 +314,35 @@ isl_mocs(const struct isl_device *dev, isl_surf_usage_flags_t usage,
    return dev->mocs.internal | mask;
 }
 
+/**
+ * Number of surface layouts remembered by isl_surf_init(), shared by all
+ * devices of the process.  Applications tend to create many images with the
+ * same few create infos (render targets, staging images, etc.), so a small
+ * direct-mapped cache catches most of them.
+ */
+#define ISL_SURF_CACHE_SIZE 128
+
+/**
+ * The entries are read without a lock, isl_surf_init() runs on every image
+ * creation from any number of threads.  A writer makes seq odd while it
+ * updates the entry, and readers take the lookup as a miss if seq was odd
+ * or changed while they copied the entry.
+ */
+struct isl_surf_cache_entry {
+   uint32_t seq;
+   uint32_t device_id;
+   uint32_t hash;
+   struct isl_surf_init_info info;
+   struct isl_surf surf;
+};
+
+static struct {
+   uint32_t next_device_id;
+   uint64_t hits;
+   uint64_t misses;
+   struct isl_surf_cache_entry entries[ISL_SURF_CACHE_SIZE];
+} isl_surf_cache;
+
 void
 isl_device_init(struct isl_device *dev,
                 const struct intel_device_info *info)
@@ -426,6 +457,11 @@ isl_device_init(struct isl_device *dev,
    dev->emit_depth_stencil_hiz_s = isl_emit_depth_stencil_hiz_s_get_func(dev);
    dev->null_fill_state_s = isl_null_fill_state_s_get_func(dev);
    dev->emit_cpb_control_s = isl_emit_cpb_control_s_get_func(dev);
+
+   /* Zero is reserved for devices that don't use the surface cache. */
+   do {
+      dev->surf_cache_id = p_atomic_inc_return(&isl_surf_cache.next_device_id);
+   } while (dev->surf_cache_id == 0);
 }
 
 /**
@@ -2828,10 +2864,10 @@ isl_calc_base_alignment(const struct isl_device *dev,
    return base_alignment_B;
 }
 
-bool
-isl_surf_init_s(const struct isl_device *dev,
-                struct isl_surf *surf,
-                const struct isl_surf_init_info *restrict info)
+static bool
+isl_surf_init_uncached(const struct isl_device *dev,
+                       struct isl_surf *surf,
+                       const struct isl_surf_init_info *restrict info)
 {
    /* Some sanity checks */
    assert(!(info->usage & ISL_SURF_USAGE_CPB_BIT) ||
@@ -2927,6 +2963,120 @@ isl_surf_init_s(const struct isl_device *dev,
    return true;
 }
 
+/* isl_surf_cache_key() has to copy every field of isl_surf_init_info, a new
+ * one changes the size of the struct.
+ */
+static_assert(sizeof(struct isl_surf_init_info) ==
+              ALIGN_POT(ALIGN_POT(11 * sizeof(uint32_t),
+                                  alignof(isl_surf_usage_flags_t)) +
+                        sizeof(isl_surf_usage_flags_t) +
+                        sizeof(isl_tiling_flags_t),
+                        alignof(struct isl_surf_init_info)),
+              "isl_surf_cache_key() is missing a field of isl_surf_init_info");
+
+/**
+ * Copy the fields of \p info into \p key one by one, so that the padding of
+ * the key is always zero and the key can be hashed and compared as bytes.
+ */
+static uint32_t
+isl_surf_cache_key(const struct isl_surf_init_info *restrict info,
+                   struct isl_surf_init_info *key)
+{
+   memset(key, 0, sizeof(*key));
+   key->dim = info->dim;
+   key->format = info->format;
+   key->width = info->width;
+   key->height = info->height;
+   key->depth = info->depth;
+   key->levels = info->levels;
+   key->array_len = info->array_len;
+   key->samples = info->samples;
+   key->min_alignment_B = info->min_alignment_B;
+   key->min_miptail_start_level = info->min_miptail_start_level;
+   key->row_pitch_B = info->row_pitch_B;
+   key->usage = info->usage;
+   key->tiling_flags = info->tiling_flags;
+
+   return _mesa_hash_data(key, sizeof(*key));
+}
+
+static bool
+isl_surf_cache_lookup(const struct isl_surf_cache_entry *entry,
+                      uint32_t device_id, uint32_t hash,
+                      const struct isl_surf_init_info *key,
+                      struct isl_surf *surf)
+{
+   const uint32_t seq = p_atomic_read(&entry->seq);
+   if (seq & 1)
+      return false;
+
+   if (entry->device_id != device_id || entry->hash != hash ||
+       memcmp(&entry->info, key, sizeof(*key)) != 0)
+      return false;
+
+   *surf = entry->surf;
+
+   /* The copy has to be done before seq is read again. */
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+   return p_atomic_read_relaxed(&entry->seq) == seq;
+}
+
+static void
+isl_surf_cache_insert(struct isl_surf_cache_entry *entry,
+                      uint32_t device_id, uint32_t hash,
+                      const struct isl_surf_init_info *key,
+                      const struct isl_surf *surf)
+{
+   /* If another thread is already updating the entry, let it win. */
+   const uint32_t seq = p_atomic_read_relaxed(&entry->seq);
+   if ((seq & 1) || p_atomic_cmpxchg(&entry->seq, seq, seq + 1) != seq)
+      return;
+
+   entry->device_id = device_id;
+   entry->hash = hash;
+   entry->info = *key;
+   entry->surf = *surf;
+
+   p_atomic_set(&entry->seq, seq + 2);
+}
+
+bool
+isl_surf_init_s(const struct isl_device *dev,
+                struct isl_surf *surf,
+                const struct isl_surf_init_info *restrict info)
+{
+   if (dev->surf_cache_id == 0)
+      return isl_surf_init_uncached(dev, surf, info);
+
+   struct isl_surf_init_info key;
+   const uint32_t hash = isl_surf_cache_key(info, &key);
+   struct isl_surf_cache_entry *entry =
+      &isl_surf_cache.entries[hash % ISL_SURF_CACHE_SIZE];
+
+   if (isl_surf_cache_lookup(entry, dev->surf_cache_id, hash, &key, surf)) {
+      p_atomic_inc(&isl_surf_cache.hits);
+      return true;
+   }
+   p_atomic_inc(&isl_surf_cache.misses);
+
+   /* Failures aren't cached, they are rare and callers usually retry with
+    * different parameters.
+    */
+   if (!isl_surf_init_uncached(dev, surf, info))
+      return false;
+
+   isl_surf_cache_insert(entry, dev->surf_cache_id, hash, &key, surf);
+
+   return true;
+}
+
+void
+isl_surf_cache_get_stats(uint64_t *hits, uint64_t *misses)
+{
+   *hits = p_atomic_read(&isl_surf_cache.hits);
+   *misses = p_atomic_read(&isl_surf_cache.misses);
+}
+
 void
 isl_surf_get_tile_info(const struct isl_surf *surf,
                        struct isl_tile_info *tile_info)
@@ -1347,6 +1347,13 @@ struct isl_device {
 
    uint64_t dummy_aux_address;
 
+   /**
+    * Identifies this device in the process-wide cache of surface layouts
+    * computed by isl_surf_init().  Assigned by isl_device_init(), zero
+    * disables the cache for this device.
+    */
+   uint32_t surf_cache_id;
+
    void (*surf_fill_state_s)(const struct isl_device *dev, void *state,
                              const struct isl_surf_fill_state_info *restrict info);
 
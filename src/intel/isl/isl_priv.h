@@ -99,6 +99,13 @@ typedef void (*isl_emit_cpb_control_s_func)(const struct isl_device *dev, void *
 void PRINTFLIKE(3, 4) UNUSED
 __isl_finishme(const char *file, int line, const char *fmt, ...);
 
+/**
+ * Return how many isl_surf_init() calls were answered from the surface
+ * layout cache and how many had to compute the layout, across all devices.
+ */
+void
+isl_surf_cache_get_stats(uint64_t *hits, uint64_t *misses);
+
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -0,0 +1,287 @@
+/* Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "c11/threads.h"
+#include "dev/intel_device_info.h"
+#include "isl/isl.h"
+#include "isl/isl_priv.h"
+#include "util/macros.h"
+#include "util/os_time.h"
+
+/* An assert that works regardless of NDEBUG. */
+#define t_assert(cond) \
+   do { \
+      if (!(cond)) { \
+         fprintf(stderr, "%s:%d: assertion failed\n", __FILE__, __LINE__); \
+         abort(); \
+      } \
+   } while (0)
+
+/* A mix of the create infos applications typically use for transient
+ * images: render targets, depth buffers, staging images and mipmapped
+ * textures.
+ */
+static const struct isl_surf_init_info infos[] = {
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_R8G8B8A8_UNORM,
+      .width = 1920, .height = 1080, .depth = 1,
+      .levels = 1, .array_len = 1, .samples = 1,
+      .usage = ISL_SURF_USAGE_RENDER_TARGET_BIT |
+               ISL_SURF_USAGE_TEXTURE_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_R16G16B16A16_FLOAT,
+      .width = 1920, .height = 1080, .depth = 1,
+      .levels = 1, .array_len = 1, .samples = 4,
+      .usage = ISL_SURF_USAGE_RENDER_TARGET_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_R32_FLOAT,
+      .width = 1920, .height = 1080, .depth = 1,
+      .levels = 1, .array_len = 1, .samples = 1,
+      .usage = ISL_SURF_USAGE_DEPTH_BIT | ISL_SURF_USAGE_TEXTURE_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_R8G8B8A8_UNORM,
+      .width = 256, .height = 256, .depth = 1,
+      .levels = 1, .array_len = 1, .samples = 1,
+      .usage = ISL_SURF_USAGE_TEXTURE_BIT,
+      .tiling_flags = ISL_TILING_LINEAR_BIT,
+   },
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_BC3_UNORM,
+      .width = 2048, .height = 2048, .depth = 1,
+      .levels = 12, .array_len = 1, .samples = 1,
+      .usage = ISL_SURF_USAGE_TEXTURE_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+   {
+      .dim = ISL_SURF_DIM_2D,
+      .format = ISL_FORMAT_R8G8B8A8_UNORM,
+      .width = 512, .height = 512, .depth = 1,
+      .levels = 10, .array_len = 6, .samples = 1,
+      .usage = ISL_SURF_USAGE_TEXTURE_BIT | ISL_SURF_USAGE_CUBE_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+   {
+      .dim = ISL_SURF_DIM_3D,
+      .format = ISL_FORMAT_R16G16_FLOAT,
+      .width = 64, .height = 64, .depth = 64,
+      .levels = 7, .array_len = 1, .samples = 1,
+      .usage = ISL_SURF_USAGE_TEXTURE_BIT | ISL_SURF_USAGE_STORAGE_BIT,
+      .tiling_flags = ISL_TILING_ANY_MASK,
+   },
+};
+
+static const char *platforms[] = { "skl", "tgl", "dg2", "lnl" };
+
+static void
+init_device(const char *platform, struct intel_device_info *devinfo,
+            struct isl_device *dev)
+{
+   t_assert(intel_get_device_info_from_pci_id(
+               intel_device_name_to_pci_device_id(platform), devinfo));
+   isl_device_init(dev, devinfo);
+   t_assert(dev->surf_cache_id != 0);
+}
+
+static void
+t_assert_surf_equal(const struct isl_surf *a, const struct isl_surf *b)
+{
+   t_assert(a->dim == b->dim);
+   t_assert(a->dim_layout == b->dim_layout);
+   t_assert(a->msaa_layout == b->msaa_layout);
+   t_assert(a->tiling == b->tiling);
+   t_assert(a->format == b->format);
+   t_assert(a->levels == b->levels);
+   t_assert(a->samples == b->samples);
+   t_assert(a->image_alignment_el.w == b->image_alignment_el.w);
+   t_assert(a->image_alignment_el.h == b->image_alignment_el.h);
+   t_assert(a->image_alignment_el.d == b->image_alignment_el.d);
+   t_assert(a->logical_level0_px.w == b->logical_level0_px.w);
+   t_assert(a->logical_level0_px.h == b->logical_level0_px.h);
+   t_assert(a->logical_level0_px.d == b->logical_level0_px.d);
+   t_assert(a->logical_level0_px.a == b->logical_level0_px.a);
+   t_assert(a->phys_level0_sa.w == b->phys_level0_sa.w);
+   t_assert(a->phys_level0_sa.h == b->phys_level0_sa.h);
+   t_assert(a->phys_level0_sa.d == b->phys_level0_sa.d);
+   t_assert(a->phys_level0_sa.a == b->phys_level0_sa.a);
+   t_assert(a->size_B == b->size_B);
+   t_assert(a->alignment_B == b->alignment_B);
+   t_assert(a->row_pitch_B == b->row_pitch_B);
+   t_assert(a->array_pitch_el_rows == b->array_pitch_el_rows);
+   t_assert(a->array_pitch_span == b->array_pitch_span);
+   t_assert(a->miptail_start_level == b->miptail_start_level);
+   t_assert(a->usage == b->usage);
+}
+
+/* Layouts returned from the cache must match freshly computed ones. */
+static void
+test_cached_layout_matches(const char *platform)
+{
+   struct intel_device_info devinfo;
+   struct isl_device dev, uncached_dev;
+   init_device(platform, &devinfo, &dev);
+   uncached_dev = dev;
+   uncached_dev.surf_cache_id = 0;
+
+   for (unsigned pass = 0; pass < 2; pass++) {
+      for (unsigned i = 0; i < ARRAY_SIZE(infos); i++) {
+         struct isl_surf ref, surf;
+         const bool ref_ok = isl_surf_init_s(&uncached_dev, &ref, &infos[i]);
+         const bool ok = isl_surf_init_s(&dev, &surf, &infos[i]);
+
+         t_assert(ok == ref_ok);
+         if (ok)
+            t_assert_surf_equal(&surf, &ref);
+      }
+   }
+}
+
+/* Two devices must not share each other's layouts. */
+static void
+test_devices_are_separate(void)
+{
+   struct intel_device_info devinfo0, devinfo1;
+   struct isl_device dev0, dev1;
+   init_device("skl", &devinfo0, &dev0);
+   init_device("lnl", &devinfo1, &dev1);
+   t_assert(dev0.surf_cache_id != dev1.surf_cache_id);
+
+   struct isl_surf surf;
+   uint64_t hits0, misses0, hits1, misses1;
+
+   t_assert(isl_surf_init_s(&dev0, &surf, &infos[0]));
+   isl_surf_cache_get_stats(&hits0, &misses0);
+   t_assert(isl_surf_init_s(&dev1, &surf, &infos[0]));
+   isl_surf_cache_get_stats(&hits1, &misses1);
+
+   t_assert(hits1 == hits0 && misses1 == misses0 + 1);
+}
+
+struct concurrent_ctx {
+   struct isl_device dev[2];
+   struct isl_surf ref[2][ARRAY_SIZE(infos)];
+   bool ref_ok[2][ARRAY_SIZE(infos)];
+};
+
+static int
+concurrent_thread(void *data)
+{
+   const struct concurrent_ctx *ctx = data;
+
+   for (unsigned n = 0; n < 2000; n++) {
+      for (unsigned d = 0; d < 2; d++) {
+         for (unsigned i = 0; i < ARRAY_SIZE(infos); i++) {
+            struct isl_surf surf;
+            const bool ok = isl_surf_init_s(&ctx->dev[d], &surf, &infos[i]);
+
+            t_assert(ok == ctx->ref_ok[d][i]);
+            if (ok)
+               t_assert_surf_equal(&surf, &ctx->ref[d][i]);
+         }
+      }
+   }
+
+   return 0;
+}
+
+/* Two devices fighting over the same entries from several threads must
+ * never see a torn or foreign layout.
+ */
+static void
+test_concurrent_lookups(void)
+{
+   struct intel_device_info devinfo[2];
+   struct concurrent_ctx ctx;
+   init_device("tgl", &devinfo[0], &ctx.dev[0]);
+   init_device("lnl", &devinfo[1], &ctx.dev[1]);
+
+   for (unsigned d = 0; d < 2; d++) {
+      struct isl_device uncached_dev = ctx.dev[d];
+      uncached_dev.surf_cache_id = 0;
+
+      for (unsigned i = 0; i < ARRAY_SIZE(infos); i++) {
+         ctx.ref_ok[d][i] =
+            isl_surf_init_s(&uncached_dev, &ctx.ref[d][i], &infos[i]);
+      }
+   }
+
+   thrd_t threads[4];
+   for (unsigned t = 0; t < ARRAY_SIZE(threads); t++)
+      t_assert(thrd_create(&threads[t], concurrent_thread, &ctx) == thrd_success);
+   for (unsigned t = 0; t < ARRAY_SIZE(threads); t++)
+      thrd_join(threads[t], NULL);
+}
+
+/* Time creating the same handful of surfaces over and over, which is what
+ * applications creating transient images do.
+ */
+static void
+bench_transient_images(const char *platform, unsigned iterations)
+{
+   struct intel_device_info devinfo;
+   struct isl_device dev, uncached_dev;
+   init_device(platform, &devinfo, &dev);
+   uncached_dev = dev;
+   uncached_dev.surf_cache_id = 0;
+
+   int64_t uncached_ns = 0, cached_ns = 0;
+   uint64_t hits0, misses0, hits1, misses1;
+   struct isl_surf surf;
+
+   int64_t start = os_time_get_nano();
+   for (unsigned n = 0; n < iterations; n++) {
+      for (unsigned i = 0; i < ARRAY_SIZE(infos); i++)
+         isl_surf_init_s(&uncached_dev, &surf, &infos[i]);
+   }
+   uncached_ns = os_time_get_nano() - start;
+
+   isl_surf_cache_get_stats(&hits0, &misses0);
+
+   start = os_time_get_nano();
+   for (unsigned n = 0; n < iterations; n++) {
+      for (unsigned i = 0; i < ARRAY_SIZE(infos); i++)
+         isl_surf_init_s(&dev, &surf, &infos[i]);
+   }
+   cached_ns = os_time_get_nano() - start;
+
+   isl_surf_cache_get_stats(&hits1, &misses1);
+
+   const uint64_t hits = hits1 - hits0, misses = misses1 - misses0;
+   const unsigned calls = iterations * ARRAY_SIZE(infos);
+
+   printf("%s: %u isl_surf_init() calls, hit rate %.1f%%, "
+          "%.1f ns/call uncached, %.1f ns/call cached\n",
+          platform, calls, 100.0 * hits / MAX2(hits + misses, 1),
+          (double)uncached_ns / calls, (double)cached_ns / calls);
+}
+
+int main(void)
+{
+   for (unsigned i = 0; i < ARRAY_SIZE(platforms); i++)
+      test_cached_layout_matches(platforms[i]);
+
+   test_devices_are_separate();
+   test_concurrent_lookups();
+
+   for (unsigned i = 0; i < ARRAY_SIZE(platforms); i++)
+      bench_transient_images(platforms[i], 10000);
+
+   return 0;
+}
@@ -0,0 +1,539 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * Offline compile-time and code-quality benchmark for the brw compiler.
+ *
+ * The input is a set of shader captures, written by any driver using the brw
+ * compiler (iris or ANV) when INTEL_SHADER_CAPTURE_PATH is set.  A capture
+ * holds the NIR handed to brw_compile_vs/fs/cs() along with the key, the
+ * program data and the device it was compiled for, so it can be compiled
+ * again by this tool alone, without the driver or the hardware:
+ *
+ *    INTEL_SHADER_CAPTURE_PATH=captures/ ./some-app
+ *    intel_compile_bench -r 5 captures/ > results.csv
+ *
+ * For each capture the compile time, the SIMD width of every generated
+ * program and its statistics (instruction and cycle counts, spills, fills,
+ * ...) are written out as CSV rows:
+ *
+ *    shader,stage,executable,statistic,value
+ *
+ * With -P, the time spent in each backend optimization pass and compilation
+ * phase is collected through brw_compile_params::report_pass_time and
+ * reported per SIMD width as well.  Two builds can be compared by joining
+ * their outputs on the first four columns.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "compiler/brw_compiler.h"
+#include "compiler/glsl_types.h"
+#include "compiler/nir/nir.h"
+#include "dev/intel_debug.h"
+#include "dev/intel_device_info.h"
+#include "util/macros.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/simple_mtx.h"
+
+#define MAX_COMPILERS   8
+#define MAX_STATS       4
+#define MAX_PASS_TIMES  256
+
+struct bench_pass_time {
+   unsigned simd;
+   const char *name;
+   uint64_t total_ns;
+};
+
+struct bench_compiler {
+   uint32_t pci_device_id;
+   struct brw_compiler *compiler;
+};
+
+struct bench_ctx {
+   void *mem_ctx;
+   FILE *out;
+   unsigned repeat;
+   bool pass_time;
+
+   struct bench_compiler compilers[MAX_COMPILERS];
+   unsigned compiler_count;
+
+   simple_mtx_t pass_time_mutex;
+   struct bench_pass_time pass_times[MAX_PASS_TIMES];
+   unsigned pass_time_count;
+};
+
+static void
+compiler_log(void *data, unsigned *id, const char *fmt, ...)
+{
+}
+
+/* Sums up the time reported for each pass over every run of it, per SIMD
+ * width.  Pass names are string literals in the compiler, so they can be
+ * kept around.  SIMD variants may be compiled on several threads at once.
+ */
+static void
+report_pass_time(void *data, gl_shader_stage stage, unsigned dispatch_width,
+                 const char *pass, uint64_t duration_ns)
+{
+   struct bench_ctx *ctx = data;
+   unsigned i;
+
+   simple_mtx_lock(&ctx->pass_time_mutex);
+
+   for (i = 0; i < ctx->pass_time_count; i++) {
+      if (ctx->pass_times[i].simd == dispatch_width &&
+          !strcmp(ctx->pass_times[i].name, pass))
+         break;
+   }
+
+   if (i == ctx->pass_time_count) {
+      if (i == MAX_PASS_TIMES) {
+         simple_mtx_unlock(&ctx->pass_time_mutex);
+         return;
+      }
+
+      ctx->pass_times[ctx->pass_time_count++] = (struct bench_pass_time) {
+         .simd = dispatch_width,
+         .name = pass,
+      };
+   }
+
+   ctx->pass_times[i].total_ns += duration_ns;
+
+   simple_mtx_unlock(&ctx->pass_time_mutex);
+}
+
+static struct brw_compiler *
+get_compiler(struct bench_ctx *ctx, uint32_t pci_device_id)
+{
+   for (unsigned i = 0; i < ctx->compiler_count; i++) {
+      if (ctx->compilers[i].pci_device_id == pci_device_id)
+         return ctx->compilers[i].compiler;
+   }
+
+   if (ctx->compiler_count == MAX_COMPILERS)
+      return NULL;
+
+   struct intel_device_info *devinfo =
+      rzalloc(ctx->mem_ctx, struct intel_device_info);
+   if (!intel_get_device_info_from_pci_id(pci_device_id, devinfo))
+      return NULL;
+
+   struct brw_compiler *compiler = brw_compiler_create(ctx->mem_ctx, devinfo);
+   compiler->shader_debug_log = compiler_log;
+   compiler->shader_perf_log = compiler_log;
+
+   fprintf(stderr, "Compiling for %s (0x%04x)\n", devinfo->name,
+           pci_device_id);
+
+   ctx->compilers[ctx->compiler_count++] = (struct bench_compiler) {
+      .pci_device_id = pci_device_id,
+      .compiler = compiler,
+   };
+   return compiler;
+}
+
+/* Compiles a capture once.  The compiler modifies the NIR, the program
+ * data and the SIMD width hint it is given, so every run starts from a copy.
+ */
+static const unsigned *
+compile_capture(struct bench_ctx *ctx, const struct brw_compiler *compiler,
+                const struct brw_compile_capture *capture, void *mem_ctx,
+                struct brw_compile_stats *stats, uint64_t *duration_ns,
+                char **error_str)
+{
+   const gl_shader_stage stage = capture->stage;
+   nir_shader *nir = nir_shader_clone(mem_ctx, capture->nir);
+
+   union {
+      struct brw_stage_prog_data base;
+      struct brw_vs_prog_data vs;
+      struct brw_wm_prog_data wm;
+      struct brw_cs_prog_data cs;
+   } *prog_data = ralloc(mem_ctx, __typeof__(*prog_data));
+   memcpy(prog_data, &capture->prog_data, sizeof(*prog_data));
+   prog_data->base.param =
+      ralloc_array(mem_ctx, uint32_t, capture->prog_data.base.nr_params);
+   memcpy(prog_data->base.param, capture->prog_data.base.param,
+          capture->prog_data.base.nr_params * sizeof(uint32_t));
+
+   struct brw_simd_hint simd_hint = capture->simd_hint;
+
+   const struct brw_compile_params base = {
+      .mem_ctx = mem_ctx,
+      .nir = nir,
+      .simd_hint = capture->has_simd_hint ? &simd_hint : NULL,
+      .stats = stats,
+      .log_data = ctx,
+      .report_pass_time = ctx->pass_time ? report_pass_time : NULL,
+   };
+   const unsigned *program = NULL;
+
+   const int64_t start = os_time_get_nano();
+
+   switch (stage) {
+   case MESA_SHADER_VERTEX: {
+      struct brw_compile_vs_params params = {
+         .base = base,
+         .key = &capture->key.vs,
+         .prog_data = &prog_data->vs,
+      };
+      program = brw_compile_vs(compiler, &params);
+      *error_str = params.base.error_str;
+      break;
+   }
+
+   case MESA_SHADER_FRAGMENT: {
+      struct brw_compile_fs_params params = {
+         .base = base,
+         .key = &capture->key.wm,
+         .prog_data = &prog_data->wm,
+         .vue_map = capture->has_vue_map ? &capture->vue_map : NULL,
+         .allow_spilling = capture->allow_spilling,
+         .use_rep_send = capture->use_rep_send,
+         .max_polygons = capture->max_polygons,
+      };
+      program = brw_compile_fs(compiler, &params);
+      *error_str = params.base.error_str;
+      break;
+   }
+
+   case MESA_SHADER_COMPUTE: {
+      struct brw_compile_cs_params params = {
+         .base = base,
+         .key = &capture->key.cs,
+         .prog_data = &prog_data->cs,
+      };
+      program = brw_compile_cs(compiler, &params);
+      *error_str = params.base.error_str;
+      break;
+   }
+
+   default:
+      unreachable("stage not captured");
+   }
+
+   *duration_ns = os_time_get_nano() - start;
+   return program;
+}
+
+static void
+print_statistics(struct bench_ctx *ctx, const char *shader,
+                 const char *stage, const struct brw_compile_stats *stats)
+{
+   for (unsigned i = 0; i < MAX_STATS && stats[i].dispatch_width; i++) {
+      const struct brw_compile_stats *s = &stats[i];
+      const struct {
+         const char *name;
+         uint32_t value;
+      } values[] = {
+         { "Subgroup size",                      s->dispatch_width },
+         { "Instruction Count",                  s->instructions },
+         { "SEND Count",                         s->sends },
+         { "Loop Count",                         s->loops },
+         { "Cycle Count",                        s->cycles },
+         { "Spill Count",                        s->spills },
+         { "Fill Count",                         s->fills },
+         { "Max live registers",                 s->max_live_registers },
+         { "Non SSA regs after NIR",             s->non_ssa_registers_after_nir },
+      };
+      char executable[32];
+
+      if (s->max_polygons > 1) {
+         snprintf(executable, sizeof(executable), "SIMD%ux%u",
+                  s->dispatch_width / s->max_polygons, s->max_polygons);
+      } else {
+         snprintf(executable, sizeof(executable), "SIMD%u",
+                  s->dispatch_width);
+      }
+
+      for (unsigned v = 0; v < ARRAY_SIZE(values); v++) {
+         fprintf(ctx->out, "%s,%s,%s,%s,%u\n", shader, stage, executable,
+                 values[v].name, values[v].value);
+      }
+   }
+}
+
+static void
+print_pass_times(struct bench_ctx *ctx, const char *shader, const char *stage)
+{
+   for (unsigned i = 0; i < ctx->pass_time_count; i++) {
+      const struct bench_pass_time *t = &ctx->pass_times[i];
+
+      fprintf(ctx->out, "%s,%s,SIMD%u,%s (ns),%" PRIu64 "\n",
+              shader, stage, t->simd, t->name, t->total_ns / ctx->repeat);
+   }
+}
+
+static void *
+read_file(const char *path, size_t *size)
+{
+   FILE *f = fopen(path, "rb");
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   long len = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   void *data = len > 0 ? malloc(len) : NULL;
+   if (data && fread(data, 1, len, f) != (size_t)len) {
+      free(data);
+      data = NULL;
+   }
+   fclose(f);
+
+   *size = len;
+   return data;
+}
+
+static bool
+bench_file(struct bench_ctx *ctx, const char *path)
+{
+   size_t size;
+   void *data = read_file(path, &size);
+   if (!data) {
+      fprintf(stderr, "%s: failed to read capture\n", path);
+      return false;
+   }
+
+   void *mem_ctx = ralloc_context(NULL);
+   struct brw_compile_capture capture;
+   bool ok = false;
+
+   const uint32_t pci_device_id = brw_compile_capture_device_id(data, size);
+   struct brw_compiler *compiler =
+      pci_device_id ? get_compiler(ctx, pci_device_id) : NULL;
+
+   if (!compiler) {
+      fprintf(stderr, "%s: not a capture for a known device\n", path);
+      goto fail;
+   }
+
+   if (!brw_read_compile_capture(compiler, mem_ctx, data, size, &capture)) {
+      fprintf(stderr, "%s: failed to decode capture\n", path);
+      goto fail;
+   }
+
+   compiler->extended_bindless_surface_offset =
+      capture.extended_bindless_surface_offset;
+   compiler->use_bindless_sampler_offset = capture.use_bindless_sampler_offset;
+   compiler->spilling_rate = capture.spilling_rate;
+
+   const char *stage = _mesa_shader_stage_to_abbrev(capture.stage);
+   struct brw_compile_stats stats[MAX_STATS];
+   uint64_t min_duration = UINT64_MAX;
+
+   ctx->pass_time_count = 0;
+
+   for (unsigned r = 0; r < ctx->repeat; r++) {
+      void *run_ctx = ralloc_context(mem_ctx);
+      uint64_t duration;
+      char *error_str = NULL;
+
+      memset(stats, 0, sizeof(stats));
+
+      if (!compile_capture(ctx, compiler, &capture, run_ctx, stats,
+                           &duration, &error_str)) {
+         fprintf(stderr, "%s: failed to compile: %s\n", path,
+                 error_str ? error_str : "unknown error");
+         ralloc_free(run_ctx);
+         goto fail;
+      }
+
+      min_duration = MIN2(min_duration, duration);
+      ralloc_free(run_ctx);
+   }
+
+   fprintf(ctx->out, "%s,%s,,Compile time (us),%" PRIu64 "\n",
+           path, stage, min_duration / 1000);
+   print_statistics(ctx, path, stage, stats);
+   print_pass_times(ctx, path, stage);
+   ok = true;
+
+fail:
+   ralloc_free(mem_ctx);
+   free(data);
+   return ok;
+}
+
+static int
+compare_strings(const void *a, const void *b)
+{
+   return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static unsigned
+bench_path(struct bench_ctx *ctx, const char *path)
+{
+   struct stat st;
+   if (stat(path, &st)) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      return 1;
+   }
+
+   if (!S_ISDIR(st.st_mode))
+      return bench_file(ctx, path) ? 0 : 1;
+
+   DIR *dir = opendir(path);
+   if (!dir)
+      return 1;
+
+   /* Sort the entries so that the output of two runs can be compared line
+    * by line.
+    */
+   char **entries = NULL;
+   unsigned num_entries = 0, failures = 0;
+   struct dirent *entry;
+   while ((entry = readdir(dir))) {
+      if (entry->d_name[0] == '.')
+         continue;
+
+      char **tmp = realloc(entries, (num_entries + 1) * sizeof(*entries));
+      if (!tmp ||
+          asprintf(&tmp[num_entries], "%s/%s", path, entry->d_name) < 0) {
+         entries = tmp;
+         failures++;
+         break;
+      }
+      entries = tmp;
+      num_entries++;
+   }
+   closedir(dir);
+
+   qsort(entries, num_entries, sizeof(*entries), compare_strings);
+
+   for (unsigned i = 0; i < num_entries; i++) {
+      const char *name = entries[i];
+      size_t len = strlen(name);
+
+      if (stat(name, &st) == 0 && S_ISDIR(st.st_mode))
+         failures += bench_path(ctx, name);
+      else if (len > 5 && !strcmp(name + len - 5, ".brwc"))
+         failures += !bench_file(ctx, name);
+      free(entries[i]);
+   }
+   free(entries);
+
+   return failures;
+}
+
+static void
+print_usage(const char *name)
+{
+   fprintf(stderr,
+           "Usage: %s [-r <repeat>] [-o <output.csv>] [-P] "
+           "<file.brwc|directory>...\n"
+           "\n"
+           "Captures are written by iris and ANV to the directory set in\n"
+           "INTEL_SHADER_CAPTURE_PATH.\n"
+           "\n"
+           "   -r, --repeat       compile every shader this many times and "
+           "report the fastest\n"
+           "   -o, --output       write the CSV to this file instead of "
+           "stdout\n"
+           "   -P, --pass-time    also report the time spent in each backend "
+           "pass\n",
+           name);
+}
+
+int
+main(int argc, char **argv)
+{
+   static const struct option long_options[] = {
+      { "repeat",    required_argument, NULL, 'r' },
+      { "output",    required_argument, NULL, 'o' },
+      { "pass-time", no_argument,       NULL, 'P' },
+      { "help",      no_argument,       NULL, 'h' },
+      { NULL,        0,                 NULL, 0 },
+   };
+   struct bench_ctx ctx = {
+      .out = stdout,
+      .repeat = 1,
+   };
+   int c;
+
+   while ((c = getopt_long(argc, argv, "r:o:Ph", long_options,
+                           NULL)) != -1) {
+      switch (c) {
+      case 'r': {
+         int n = atoi(optarg);
+         ctx.repeat = MAX2(n, 1);
+         break;
+      }
+      case 'o':
+         ctx.out = fopen(optarg, "w");
+         if (!ctx.out) {
+            fprintf(stderr, "%s: %s\n", optarg, strerror(errno));
+            return EXIT_FAILURE;
+         }
+         break;
+      case 'P':
+         ctx.pass_time = true;
+         break;
+      default:
+         print_usage(argv[0]);
+         return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+
+   if (optind == argc) {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   /* Recompiling the captures shouldn't capture them again. */
+   unsetenv("INTEL_SHADER_CAPTURE_PATH");
+
+   process_intel_debug_variable();
+   glsl_type_singleton_init_or_ref();
+   simple_mtx_init(&ctx.pass_time_mutex, mtx_plain);
+   ctx.mem_ctx = ralloc_context(NULL);
+
+   fprintf(ctx.out, "shader,stage,executable,statistic,value\n");
+
+   unsigned failures = 0;
+   for (int i = optind; i < argc; i++)
+      failures += bench_path(&ctx, argv[i]);
+
+   ralloc_free(ctx.mem_ctx);
+   simple_mtx_destroy(&ctx.pass_time_mutex);
+   glsl_type_singleton_decref();
+
+   if (ctx.out != stdout)
+      fclose(ctx.out);
+
+   return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
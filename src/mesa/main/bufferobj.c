@@ -2327,7 +2327,7 @@ _mesa_NamedBufferStorageMemEXT_no_error(GLuint buffer, GLsizeiptr size,
 }
 
 
-static ALWAYS_INLINE void
+static ALWAYS_INLINE bool
 buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
             GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage,
             const char *func, bool no_error)
@@ -2345,7 +2345,7 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    if (!no_error) {
       if (size < 0) {
          _mesa_error(ctx, GL_INVALID_VALUE, "%s(size < 0)", func);
-         return;
+         return false;
       }
 
       switch (usage) {
@@ -2372,12 +2372,12 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
       if (!valid_usage) {
          _mesa_error(ctx, GL_INVALID_ENUM, "%s(invalid usage: %s)", func,
                      _mesa_enum_to_string(usage));
-         return;
+         return false;
       }
 
       if (bufObj->Immutable || bufObj->HandleAllocated) {
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s(immutable)", func);
-         return;
+         return false;
       }
    }
 
@@ -2415,7 +2415,10 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
       } else {
          _mesa_error(ctx, GL_OUT_OF_MEMORY, "%s", func);
       }
+      return false;
    }
+
+   return true;
 }
 
 static void
@@ -2519,6 +2522,66 @@ _mesa_NamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const GLvoid *data,
                      "glNamedBufferDataEXT");
 }
 
+/**
+ * glBufferData with the contents coming from a glthread upload buffer.
+ *
+ * glthread uses this for payloads too large to be copied into a batch.
+ * The new storage is allocated without data and filled with a GPU copy,
+ * which is only done if the allocation succeeded, so that errors leave
+ * the buffer contents untouched like glBufferData does.
+ */
+void
+_mesa_buffer_data_from_upload(struct gl_context *ctx, GLuint target_or_name,
+                              GLsizeiptr size, GLenum usage, bool named,
+                              bool ext_dsa, struct gl_buffer_object *src,
+                              unsigned src_offset, bool src_is_storage)
+{
+   struct gl_buffer_object *dst;
+   GLenum target = GL_NONE;
+   const char *func;
+
+   /* Handle behavior for all 3 variants. */
+   if (named && ext_dsa) {
+      func = "glNamedBufferDataEXT";
+      dst = _mesa_lookup_bufferobj(ctx, target_or_name);
+      if (!handle_bind_buffer_gen(ctx, target_or_name, &dst, func, false))
+         goto done;
+   } else if (named) {
+      func = "glNamedBufferData";
+      dst = _mesa_lookup_bufferobj_err(ctx, target_or_name, func);
+      if (!dst)
+         goto done;
+   } else {
+      assert(!ext_dsa);
+      func = "glBufferData";
+      target = target_or_name;
+      dst = get_buffer(ctx, func, target, GL_INVALID_OPERATION);
+      if (!dst)
+         goto done;
+   }
+
+   if (src_is_storage) {
+      /* glthread allocated src with the parameters buffer_data() uses and
+       * wrote the data into it.  Do everything buffer_data() does except
+       * the allocation, which is what it does for size 0, and make the
+       * storage of src the new data store.
+       */
+      assert(src_offset == 0 && src->Size == size);
+      if (buffer_data(ctx, dst, target, 0, NULL, usage, func, false)) {
+         _mesa_buffer_unmap_all_mappings(ctx, src);
+         pipe_resource_reference(&dst->buffer, src->buffer);
+         dst->private_refcount_ctx = ctx;
+         dst->Size = size;
+      }
+   } else if (buffer_data(ctx, dst, target, size, NULL, usage, func, false)) {
+      bufferobj_copy_subdata(ctx, src, dst, src_offset, 0, size);
+   }
+
+done:
+   /* The caller passes the reference to this function, so unreference it. */
+   _mesa_reference_buffer_object(ctx, &src, NULL);
+}
+
 static bool
 validate_buffer_sub_data(struct gl_context *ctx,
                          struct gl_buffer_object *bufObj,
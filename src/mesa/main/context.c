@@ -1574,6 +1574,11 @@ _mesa_share_state(struct gl_context *ctx, struct gl_context *ctxToShare)
    if (ctx && ctxToShare && ctx->Shared && ctxToShare->Shared) {
       struct gl_shared_state *oldShared = NULL;
 
+      /* The compile jobs of the context point to it, and they can't outlive
+       * it if another context keeps the old share group's queue around.
+       */
+      _mesa_finish_shader_compile_queue(ctx);
+
       /* save ref to old state to prevent it from being deleted immediately */
       _mesa_reference_shared_state(ctx, &oldShared, ctx->Shared);
 
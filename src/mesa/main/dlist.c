@@ -616,8 +616,9 @@ typedef enum
    OPCODE_VERTEX_LIST_LOOPBACK,
    OPCODE_VERTEX_LIST_COPY_CURRENT,
 
-   /* The following three are meta instructions */
+   /* The following four are meta instructions */
    OPCODE_ERROR,                /* raise compiled-in error */
+   OPCODE_NOP,                  /* removed by optimize_list() */
    OPCODE_CONTINUE,
    OPCODE_END_OF_LIST
 } OpCode;
@@ -754,7 +755,7 @@ vbo_destroy_vertex_list(struct gl_context *ctx, struct vbo_save_vertex_list *nod
       pipe_vertex_state_reference(&node->state[mode], NULL);
    }
 
-   if (node->modes) {
+   if (node->num_draws > 1) {
       free(node->modes);
       free(node->start_counts);
    }
@@ -767,6 +768,116 @@ vbo_destroy_vertex_list(struct gl_context *ctx, struct vbo_save_vertex_list *nod
    free(node->cold);
 }
 
+/**
+ * Append the draws of vertex list b to vertex list a, which precedes it in
+ * the display list with nothing but OPCODE_NOP in between.  b is left
+ * without its current attrib data and must be destroyed by the caller.
+ * This is only possible when both draw from the same vertex buffer with the
+ * same layout, so that a single draw_vertex_state can do both.
+ */
+bool
+_mesa_dlist_merge_vertex_list_draws(struct vbo_save_vertex_list *a,
+                                    struct vbo_save_vertex_list *b)
+{
+   /* a must not update the current attribs unless b does it again after. */
+   if (a->header.opcode == OPCODE_VERTEX_LIST_COPY_CURRENT &&
+       b->header.opcode != OPCODE_VERTEX_LIST_COPY_CURRENT)
+      return false;
+
+   /* Only the first primitive of a list can continue a primitive of the
+    * previous list, and loopback skips cold->wrap_count vertices of it.
+    * That count would be wrong for b's primitives after merging, so b
+    * must start with a new primitive.
+    */
+   if (!a->num_draws || !b->num_draws || !a->draw_begins || !b->draw_begins ||
+       a->cold->ib.obj != b->cold->ib.obj || a->ctx != b->ctx)
+      return false;
+
+   for (gl_vertex_processing_mode mode = VP_MODE_FF; mode < VP_MODE_MAX; ++mode) {
+      if (a->cold->VAO[mode] != b->cold->VAO[mode] ||
+          !a->state[mode] != !b->state[mode])
+         return false;
+   }
+
+   const unsigned num_draws = a->num_draws + b->num_draws;
+   const unsigned prim_count = a->cold->prim_count + b->cold->prim_count;
+   struct pipe_draw_start_count_bias *draws =
+      malloc(num_draws * sizeof(struct pipe_draw_start_count_bias));
+   uint8_t *modes = malloc(num_draws);
+   struct _mesa_prim *prims =
+      realloc(a->cold->prims, prim_count * sizeof(struct _mesa_prim));
+
+   if (prims)
+      a->cold->prims = prims;
+
+   if (!draws || !modes || !prims) {
+      free(draws);
+      free(modes);
+      return false;
+   }
+
+   const struct vbo_save_vertex_list *lists[] = { a, b };
+   bool same_mode = true;
+
+   for (unsigned i = 0, d = 0; i < ARRAY_SIZE(lists); i++) {
+      const struct vbo_save_vertex_list *node = lists[i];
+
+      memcpy(&draws[d], node->num_draws > 1 ? node->start_counts :
+                                              &node->start_count,
+             node->num_draws * sizeof(struct pipe_draw_start_count_bias));
+
+      for (unsigned j = 0; j < node->num_draws; j++, d++) {
+         modes[d] = node->modes ? node->modes[j] : node->cold->info.mode;
+         same_mode &= modes[d] == modes[0];
+      }
+   }
+
+   if (a->num_draws > 1) {
+      free(a->modes);
+      free(a->start_counts);
+   }
+
+   a->start_counts = draws;
+   a->num_draws = num_draws;
+
+   if (same_mode) {
+      a->cold->info.mode = modes[0];
+      a->mode = modes[0];
+      free(modes);
+      a->modes = NULL;
+   } else {
+      a->modes = modes;
+   }
+
+   memcpy(&a->cold->prims[a->cold->prim_count], b->cold->prims,
+          b->cold->prim_count * sizeof(struct _mesa_prim));
+   a->cold->prim_count = prim_count;
+   a->cold->vertex_count += b->cold->vertex_count;
+   a->cold->min_index = MIN2(a->cold->min_index, b->cold->min_index);
+   a->cold->max_index = MAX2(a->cold->max_index, b->cold->max_index);
+   a->cold->bo_bytes_used = MAX2(a->cold->bo_bytes_used,
+                                 b->cold->bo_bytes_used);
+
+   /* The current attribs are set from the last vertex of b. */
+   free(a->cold->current_data);
+   a->cold->current_data = b->cold->current_data;
+   b->cold->current_data = NULL;
+   a->header.opcode = b->header.opcode;
+   return true;
+}
+
+static bool
+vbo_merge_vertex_lists(struct gl_context *ctx, struct vbo_save_vertex_list *a,
+                       struct vbo_save_vertex_list *b)
+{
+   if (!_mesa_dlist_merge_vertex_list_draws(a, b))
+      return false;
+
+   vbo_destroy_vertex_list(ctx, b);
+   b->header.opcode = OPCODE_NOP;
+   return true;
+}
+
 static void
 vbo_print_vertex_list(struct gl_context *ctx, struct vbo_save_vertex_list *node, OpCode op, FILE *f)
 {
@@ -13052,6 +13163,8 @@ execute_list(struct gl_context *ctx, GLuint list)
             vbo_save_playback_vertex_list_loopback(ctx, &n[0]);
             break;
 
+         case OPCODE_NOP:
+            break;
          case OPCODE_CONTINUE:
             n = (Node *) get_pointer(&n[1]);
             continue;
@@ -13316,6 +13429,256 @@ replace_op_vertex_list_recursively(struct gl_context *ctx, struct gl_display_lis
 }
 
 
+/**
+ * State that optimize_list() tracks.  Opcodes setting the same state share
+ * a slot, so that the last setter of each piece of state is known.
+ */
+enum dlist_state_slot {
+   SLOT_NONE = 0,
+   SLOT_ALPHA_FUNC,
+   SLOT_BIND_TEXTURE,
+   SLOT_BLEND_COLOR,
+   SLOT_BLEND_EQUATION,
+   SLOT_BLEND_FUNC,
+   SLOT_COLOR_MASK,
+   SLOT_CULL_FACE,
+   SLOT_DEPTH_FUNC,
+   SLOT_DEPTH_MASK,
+   SLOT_DEPTH_RANGE,
+   SLOT_ENABLE,
+   SLOT_FRONT_FACE,
+   SLOT_LINE_STIPPLE,
+   SLOT_LINE_WIDTH,
+   SLOT_LOGIC_OP,
+   SLOT_POINT_SIZE,
+   SLOT_POLYGON_MODE,
+   SLOT_POLYGON_OFFSET,
+   SLOT_SCISSOR,
+   SLOT_SHADE_MODEL,
+   SLOT_STENCIL_FUNC,
+   SLOT_STENCIL_MASK,
+   SLOT_STENCIL_OP,
+   SLOT_USE_PROGRAM,
+   SLOT_VIEWPORT,
+};
+
+/**
+ * Opcodes that only set the state of their slot, and so are redundant if
+ * the previous setter of that state had the same opcode and parameters.
+ * Keyed opcodes have one slot per value of their first parameter (the
+ * enable cap or the texture target).
+ *
+ * Everything else, including the indexed variants of these opcodes,
+ * glActiveTexture and glPushAttrib/glPopAttrib, may read or change any
+ * state and ends the search for redundant setters.
+ */
+static const struct {
+   uint8_t slot;
+   uint8_t nparams;
+   bool keyed;
+} dlist_state_setters[OPCODE_END_OF_LIST + 1] = {
+   [OPCODE_ALPHA_FUNC]              = { SLOT_ALPHA_FUNC, 2 },
+   [OPCODE_BIND_TEXTURE]            = { SLOT_BIND_TEXTURE, 2, true },
+   [OPCODE_BLEND_COLOR]             = { SLOT_BLEND_COLOR, 4 },
+   [OPCODE_BLEND_EQUATION]          = { SLOT_BLEND_EQUATION, 1 },
+   [OPCODE_BLEND_EQUATION_SEPARATE] = { SLOT_BLEND_EQUATION, 2 },
+   [OPCODE_BLEND_FUNC_SEPARATE]     = { SLOT_BLEND_FUNC, 4 },
+   [OPCODE_COLOR_MASK]              = { SLOT_COLOR_MASK, 4 },
+   [OPCODE_CULL_FACE]               = { SLOT_CULL_FACE, 1 },
+   [OPCODE_DEPTH_FUNC]              = { SLOT_DEPTH_FUNC, 1 },
+   [OPCODE_DEPTH_MASK]              = { SLOT_DEPTH_MASK, 1 },
+   [OPCODE_DEPTH_RANGE]             = { SLOT_DEPTH_RANGE, 2 },
+   [OPCODE_DISABLE]                 = { SLOT_ENABLE, 1, true },
+   [OPCODE_ENABLE]                  = { SLOT_ENABLE, 1, true },
+   [OPCODE_FRONT_FACE]              = { SLOT_FRONT_FACE, 1 },
+   [OPCODE_LINE_STIPPLE]            = { SLOT_LINE_STIPPLE, 2 },
+   [OPCODE_LINE_WIDTH]              = { SLOT_LINE_WIDTH, 1 },
+   [OPCODE_LOGIC_OP]                = { SLOT_LOGIC_OP, 1 },
+   [OPCODE_POINT_SIZE]              = { SLOT_POINT_SIZE, 1 },
+   [OPCODE_POLYGON_MODE]            = { SLOT_POLYGON_MODE, 2 },
+   [OPCODE_POLYGON_OFFSET]          = { SLOT_POLYGON_OFFSET, 2 },
+   [OPCODE_SCISSOR]                 = { SLOT_SCISSOR, 4 },
+   [OPCODE_SHADE_MODEL]             = { SLOT_SHADE_MODEL, 1 },
+   [OPCODE_STENCIL_FUNC]            = { SLOT_STENCIL_FUNC, 3 },
+   [OPCODE_STENCIL_FUNC_SEPARATE]   = { SLOT_STENCIL_FUNC, 4 },
+   [OPCODE_STENCIL_MASK]            = { SLOT_STENCIL_MASK, 1 },
+   [OPCODE_STENCIL_MASK_SEPARATE]   = { SLOT_STENCIL_MASK, 2 },
+   [OPCODE_STENCIL_OP]              = { SLOT_STENCIL_OP, 3 },
+   [OPCODE_STENCIL_OP_SEPARATE]     = { SLOT_STENCIL_OP, 4 },
+   [OPCODE_USE_PROGRAM]             = { SLOT_USE_PROGRAM, 1 },
+   [OPCODE_VIEWPORT]                = { SLOT_VIEWPORT, 4 },
+};
+
+#define MAX_TRACKED_STATE_SETTERS 64
+
+/**
+ * Compare the parameters of two instructions with the same state setter
+ * opcode.  Parameters narrower than a Node don't initialize the whole Node,
+ * so they have to be compared by their own type.
+ */
+static bool
+state_setter_params_equal(OpCode opcode, const Node *a, const Node *b)
+{
+   switch (opcode) {
+   case OPCODE_COLOR_MASK:
+      return a[1].b == b[1].b && a[2].b == b[2].b &&
+             a[3].b == b[3].b && a[4].b == b[4].b;
+   case OPCODE_DEPTH_MASK:
+      return a[1].b == b[1].b;
+   case OPCODE_LINE_STIPPLE:
+      return a[1].i == b[1].i && a[2].us == b[2].us;
+   default:
+      /* GLenum, GLint, GLuint and GLfloat fill the whole Node.  Floats are
+       * compared bitwise, so e.g. -0.0 and 0.0 are treated as different.
+       */
+      for (unsigned i = 1; i <= dlist_state_setters[opcode].nparams; i++) {
+         if (a[i].ui != b[i].ui)
+            return false;
+      }
+      return true;
+   }
+}
+
+/**
+ * Optimize a display list after it's been compiled, so that glCallList
+ * does less work:
+ *
+ * - State setters which set the same values as the previous setter of the
+ *   same state are replaced by OPCODE_NOP.  CAD applications often emit
+ *   the same glEnable or glBindTexture before every object.
+ *
+ * - Consecutive vertex lists using the same vertex buffer are merged into
+ *   a single multi-draw.  Such vertex lists are usually separated by state
+ *   changes removed above.
+ *
+ * Small lists are compacted by EndList, so the NOPs only remain in lists
+ * that need more than one block.
+ */
+static void
+optimize_list(struct gl_context *ctx, struct gl_display_list *dlist)
+{
+   struct {
+      uint8_t slot;
+      GLuint key;
+      const Node *n;
+   } setters[MAX_TRACKED_STATE_SETTERS];
+   unsigned num_setters = 0;
+   struct vbo_save_vertex_list *last_vertex_list = NULL;
+   unsigned removed_setters = 0, merged_draws = 0;
+   Node *n = dlist->Head;
+
+   while (true) {
+      const OpCode opcode = n[0].opcode;
+
+      switch (opcode) {
+      case OPCODE_VERTEX_LIST:
+      case OPCODE_VERTEX_LIST_COPY_CURRENT: {
+         struct vbo_save_vertex_list *node = (struct vbo_save_vertex_list *)n;
+
+         /* Drawing doesn't change any of the tracked state. */
+         if (last_vertex_list &&
+             vbo_merge_vertex_lists(ctx, last_vertex_list, node))
+            merged_draws++;
+         else
+            last_vertex_list = node;
+         break;
+      }
+      case OPCODE_NOP:
+         break;
+      case OPCODE_CONTINUE:
+         n = (Node *)get_pointer(&n[1]);
+         continue;
+      case OPCODE_END_OF_LIST:
+         if (MESA_VERBOSE & VERBOSE_DISPLAY_LIST) {
+            _mesa_debug(ctx, "list %u: removed %u state changes, "
+                        "merged %u vertex lists\n", dlist->Name,
+                        removed_setters, merged_draws);
+         }
+         return;
+      default: {
+         const unsigned slot = dlist_state_setters[opcode].slot;
+
+         if (slot == SLOT_NONE) {
+            num_setters = 0;
+            last_vertex_list = NULL;
+            break;
+         }
+
+         const GLuint key = dlist_state_setters[opcode].keyed ? n[1].ui : 0;
+         unsigned i;
+
+         for (i = 0; i < num_setters; i++) {
+            if (setters[i].slot == slot && setters[i].key == key)
+               break;
+         }
+
+         if (i < num_setters) {
+            const Node *prev = setters[i].n;
+
+            if (prev[0].opcode == opcode &&
+                state_setter_params_equal(opcode, prev, n)) {
+               n[0].opcode = OPCODE_NOP;
+               removed_setters++;
+               break;
+            }
+         } else if (num_setters < ARRAY_SIZE(setters)) {
+            setters[num_setters].slot = slot;
+            setters[num_setters].key = key;
+            num_setters++;
+         }
+
+         if (i < num_setters)
+            setters[i].n = n;
+         last_vertex_list = NULL;
+         break;
+      }
+      }
+
+      assert(n[0].InstSize > 0);
+      n += n[0].InstSize;
+   }
+}
+
+
+/**
+ * Copy the instructions of a single-block display list to dst, leaving out
+ * the OPCODE_NOPs.  Returns the number of nodes written, or that would be
+ * written if dst is NULL.
+ */
+static unsigned
+compact_list_block(Node *dst, const Node *src)
+{
+   Node *last = NULL;
+   unsigned pos = 0;
+
+   for (const Node *n = src;; n += n[0].InstSize) {
+      const OpCode opcode = n[0].opcode;
+
+      if (opcode == OPCODE_NOP)
+         continue;
+
+      /* Vertex lists are 8-byte aligned, see dlist_alloc. */
+      if (sizeof(void *) == 8 && pos % 2 == 1 &&
+          (opcode == OPCODE_VERTEX_LIST ||
+           opcode == OPCODE_VERTEX_LIST_LOOPBACK ||
+           opcode == OPCODE_VERTEX_LIST_COPY_CURRENT)) {
+         if (dst)
+            last->InstSize++;
+         pos++;
+      }
+
+      if (dst) {
+         memcpy(&dst[pos], n, n[0].InstSize * sizeof(Node));
+         last = &dst[pos];
+      }
+      pos += n[0].InstSize;
+
+      if (opcode == OPCODE_END_OF_LIST)
+         return pos;
+   }
+}
+
+
 /**
  * End definition of current display list.
  */
@@ -13352,6 +13715,8 @@ _mesa_EndList(void)
    if (ctx->ListState.Current.UseLoopback)
       replace_op_vertex_list_recursively(ctx, ctx->ListState.CurrentList);
 
+   optimize_list(ctx, ctx->ListState.CurrentList);
+
    struct gl_dlist_state *list = &ctx->ListState;
    list->CurrentList->execute_glthread =
       _mesa_glthread_should_execute_list(ctx, list->CurrentList);
@@ -13365,15 +13730,16 @@ _mesa_EndList(void)
        * are now stored in the same array instead of being scattered in memory.
        */
       list->CurrentList->small_list = true;
+      const unsigned count = compact_list_block(NULL, list->CurrentBlock);
       unsigned start;
 
       if (ctx->Shared->small_dlist_store.size == 0) {
-         util_idalloc_init(&ctx->Shared->small_dlist_store.free_idx, MAX2(1, list->CurrentPos));
+         util_idalloc_init(&ctx->Shared->small_dlist_store.free_idx, MAX2(1, count));
       }
 
-      start = util_idalloc_alloc_range(&ctx->Shared->small_dlist_store.free_idx, list->CurrentPos);
+      start = util_idalloc_alloc_range(&ctx->Shared->small_dlist_store.free_idx, count);
 
-      if ((start + list->CurrentPos) > ctx->Shared->small_dlist_store.size) {
+      if ((start + count) > ctx->Shared->small_dlist_store.size) {
          ctx->Shared->small_dlist_store.size =
             ctx->Shared->small_dlist_store.free_idx.num_elements * 32;
          ctx->Shared->small_dlist_store.ptr = realloc(
@@ -13381,11 +13747,10 @@ _mesa_EndList(void)
             ctx->Shared->small_dlist_store.size * sizeof(Node));
       }
       list->CurrentList->start = start;
-      list->CurrentList->count = list->CurrentPos;
+      list->CurrentList->count = count;
 
-      memcpy(&ctx->Shared->small_dlist_store.ptr[start],
-             list->CurrentBlock,
-             list->CurrentList->count * sizeof(Node));
+      compact_list_block(&ctx->Shared->small_dlist_store.ptr[start],
+                         list->CurrentBlock);
 
       assert (ctx->Shared->small_dlist_store.ptr[start + list->CurrentList->count - 1].opcode == OPCODE_END_OF_LIST);
 
@@ -13899,6 +14264,9 @@ print_list(struct gl_context *ctx, GLuint list, const char *fname)
             fprintf(f, "Error: %s %s\n", enum_string(n[1].e),
                    (const char *) get_pointer(&n[2]));
             break;
+         case OPCODE_NOP:
+            fprintf(f, "NOP\n");
+            break;
          case OPCODE_CONTINUE:
             fprintf(f, "DISPLAY-LIST-CONTINUE\n");
             n = (Node *) get_pointer(&n[1]);
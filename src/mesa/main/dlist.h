@@ -35,6 +35,7 @@
 #include <stdio.h>
 
 struct gl_context;
+struct vbo_save_vertex_list;
 
 /**
  * Display list node.
@@ -82,6 +83,10 @@ _mesa_dlist_alloc_vertex_list(struct gl_context *ctx,
 void
 _mesa_delete_list(struct gl_context *ctx, struct gl_display_list *dlist);
 
+bool
+_mesa_dlist_merge_vertex_list_draws(struct vbo_save_vertex_list *a,
+                                    struct vbo_save_vertex_list *b);
+
 void
 _mesa_init_dispatch_save(const struct gl_context *);
 
@@ -39,6 +39,7 @@
 #include "errors.h"
 #include "light.h"
 #include "mtypes.h"
+#include "shaderobj.h"
 #include "enums.h"
 #include "state.h"
 #include "texstate.h"
@@ -513,6 +514,9 @@ _mesa_set_enable(struct gl_context *ctx, GLenum cap, GLboolean state)
          break;
       case GL_DEBUG_OUTPUT:
       case GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB:
+         /* Compiles only run on other threads while the output is off. */
+         if (cap == GL_DEBUG_OUTPUT && state)
+            _mesa_finish_shader_compile_queue(ctx);
          _mesa_set_debug_state_int(ctx, cap, state);
          _mesa_update_debug_callback(ctx);
          break;
@@ -243,7 +243,10 @@ _mesa_glthread_init(struct gl_context *ctx)
    }
    glthread->next_batch = &glthread->batches[glthread->next];
    glthread->used = 0;
+   glthread->batch_limit = MARSHAL_MIN_BATCH_SIZE / 8 - 1;
+   glthread->max_inflight = MARSHAL_MIN_INFLIGHT_BATCHES;
    glthread->stats.queue = &glthread->queue;
+   glthread->stats.batch_size = MARSHAL_MIN_BATCH_SIZE;
 
    _mesa_glthread_init_call_fence(&glthread->LastProgramChangeBatch);
    _mesa_glthread_init_call_fence(&glthread->LastDListChangeBatchIndex);
@@ -353,6 +356,92 @@ glthread_finalize_batch(struct glthread_state *glthread,
    glthread->LastBindBuffer2 = NULL;
 }
 
+/* Return the number of submitted batches that are still queued or executing.
+ * Batches are executed in order, so walk back from the last one.
+ */
+static unsigned
+glthread_get_queue_depth(struct glthread_state *glthread)
+{
+   unsigned depth = 0;
+   unsigned i = glthread->last;
+
+   while (depth < MARSHAL_MAX_INFLIGHT_BATCHES &&
+          !util_queue_fence_is_signalled(&glthread->batches[i].fence)) {
+      depth++;
+      i = (i + MARSHAL_MAX_BATCHES - 1) % MARSHAL_MAX_BATCHES;
+   }
+
+   return depth;
+}
+
+static void
+glthread_wait_for_batch(struct glthread_state *glthread, unsigned index)
+{
+   /* Only read the clock when we have to wait, because os_time_get_nano() is
+    * expensive if the clock source is not TSC.
+    */
+   int64_t start = os_time_get_nano();
+   util_queue_fence_wait(&glthread->batches[index].fence);
+   p_atomic_add(&glthread->stats.stall_time_us,
+                (os_time_get_nano() - start) / 1000);
+}
+
+/* Wait until there is room for one more batch in flight, and adapt the batch
+ * size and the number of batches in flight to how far behind the worker
+ * thread is.
+ */
+static void
+glthread_throttle(struct glthread_state *glthread)
+{
+   unsigned depth = glthread_get_queue_depth(glthread);
+
+   if (depth >= glthread->max_inflight) {
+      /* Wait for the oldest batch that would exceed the limit. Since batches
+       * are executed in order, all older batches are done after that.
+       */
+      glthread_wait_for_batch(glthread,
+                              (glthread->last + MARSHAL_MAX_BATCHES + 1 -
+                               glthread->max_inflight) % MARSHAL_MAX_BATCHES);
+      depth = glthread->max_inflight - 1;
+
+      /* The application thread is ahead of the worker thread. Allow more
+       * batches in flight, so that short bursts of calls don't block it.
+       */
+      if (glthread->max_inflight < MARSHAL_MAX_INFLIGHT_BATCHES)
+         glthread->max_inflight++;
+   }
+
+   unsigned batch_size = (glthread->batch_limit + 1) * 8;
+
+   if (depth >= 2) {
+      /* The worker thread is behind, so the per-batch overhead is what
+       * matters. Use larger batches.
+       */
+      batch_size = MIN2(batch_size * 2, MARSHAL_MAX_CMD_BUFFER_SIZE);
+   } else if (depth == 0) {
+      /* The worker thread is idle. Use smaller batches to give it work
+       * sooner, and go back to fewer batches in flight.
+       */
+      batch_size = MAX2(batch_size / 2, MARSHAL_MIN_BATCH_SIZE);
+
+      if (glthread->max_inflight > MARSHAL_MIN_INFLIGHT_BATCHES)
+         glthread->max_inflight--;
+   }
+
+   glthread->batch_limit = batch_size / 8 - 1;
+   glthread->stats.batch_size = batch_size;
+
+   /* The HUD resets the maximum from another thread. */
+   unsigned max_depth = p_atomic_read(&glthread->stats.max_queue_depth);
+   while (max_depth < depth + 1) {
+      unsigned old = p_atomic_cmpxchg(&glthread->stats.max_queue_depth,
+                                      max_depth, depth + 1);
+      if (old == max_depth)
+         break;
+      max_depth = old;
+   }
+}
+
 void
 _mesa_glthread_flush_batch(struct gl_context *ctx)
 {
@@ -370,6 +459,7 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
 
    glthread_apply_thread_sched_policy(ctx, false);
    glthread_finalize_batch(glthread, &glthread->stats.num_offloaded_items);
+   glthread_throttle(glthread);
 
    struct glthread_batch *next = glthread->next_batch;
 
@@ -406,7 +496,7 @@ _mesa_glthread_finish(struct gl_context *ctx)
    bool synced = false;
 
    if (!util_queue_fence_is_signalled(&last->fence)) {
-      util_queue_fence_wait(&last->fence);
+      glthread_wait_for_batch(glthread, glthread->last);
       synced = true;
    }
 
@@ -24,21 +24,30 @@
 #ifndef _GLTHREAD_H
 #define _GLTHREAD_H
 
-/* The size of one batch and the maximum size of one call.
+/* The minimum and maximum size of one batch.
  *
- * This should be as low as possible, so that:
+ * The size should be as low as possible, so that:
  * - multiple synchronizations within a frame don't slow us down much
  * - a smaller number of calls per frame can still get decent parallelism
  * - the memory footprint of the queue is low, and with that comes a lower
  *   chance of experiencing CPU cache thrashing
  * but it should be high enough so that u_queue overhead remains negligible.
+ *
+ * Batches start at the minimum size, and grow up to the maximum while the
+ * worker thread is behind, because that's when the per-batch overhead
+ * matters.  All batch slots are allocated at the maximum size as part of
+ * the context, and pages a batch has grown into stay resident.  Both are
+ * 8 KB by default, which keeps the fixed size used before: larger batches
+ * haven't been shown to help yet.
  */
+#define MARSHAL_MIN_BATCH_SIZE (8 * 1024)
 #define MARSHAL_MAX_CMD_BUFFER_SIZE (8 * 1024)
 
-/* We need to leave 1 slot at the end to insert the END marker for unmarshal
- * calls that look ahead to know where the batch ends.
+/* The maximum size of one call, which must fit in a batch of the minimum
+ * size. We need to leave 1 slot at the end to insert the END marker for
+ * unmarshal calls that look ahead to know where the batch ends.
  */
-#define MARSHAL_MAX_CMD_SIZE (MARSHAL_MAX_CMD_BUFFER_SIZE - 8)
+#define MARSHAL_MAX_CMD_SIZE (MARSHAL_MIN_BATCH_SIZE - 8)
 
 /* The number of batch slots in memory.
  *
@@ -48,6 +57,17 @@
  */
 #define MARSHAL_MAX_BATCHES 8
 
+/* The minimum and maximum number of batches that can be queued or executing
+ * at the same time, which is every slot except the one being filled. The
+ * limit starts at the minimum and grows when the application thread has to
+ * wait for the worker thread, which happens with bursts of large calls such
+ * as buffer uploads.
+ *
+ * Like the batch size, the limit is fixed by default.
+ */
+#define MARSHAL_MAX_INFLIGHT_BATCHES (MARSHAL_MAX_BATCHES - 1)
+#define MARSHAL_MIN_INFLIGHT_BATCHES MARSHAL_MAX_INFLIGHT_BATCHES
+
 /* Special value for glEnableClientState(GL_PRIMITIVE_RESTART_NV). */
 #define VERT_ATTRIB_PRIMITIVE_RESTART_NV -1
 
@@ -232,6 +252,15 @@ struct glthread_state
    /** Number of uint64_t elements filled already. */
    unsigned used;
 
+   /**
+    * Number of uint64_t elements a batch can hold before it's flushed,
+    * excluding the END marker.
+    */
+   unsigned batch_limit;
+
+   /** Maximum number of batches that can be queued or executing. */
+   unsigned max_inflight;
+
    /** Upload buffer. */
    struct gl_buffer_object *upload_buffer;
    uint8_t *upload_ptr;
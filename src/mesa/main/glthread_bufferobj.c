@@ -62,6 +62,49 @@ new_upload_buffer(struct gl_context *ctx, GLsizeiptr size, uint8_t **ptr)
    return obj;
 }
 
+/* Allocate the new data store of a glBufferData call with the same
+ * parameters as buffer_data() in bufferobj.c, and write the data into it.
+ * This is only done for usage hints that get the same kind of CPU-visible
+ * buffer as the upload buffers above, because other buffers might not be
+ * mappable without the driver context.
+ */
+static struct gl_buffer_object *
+new_buffer_storage(struct gl_context *ctx, GLenum target, GLsizeiptr size,
+                   GLenum usage, const void *data)
+{
+   if ((usage != GL_STREAM_DRAW && usage != GL_STREAM_COPY) ||
+       target == GL_PIXEL_PACK_BUFFER || target == GL_PIXEL_UNPACK_BUFFER)
+      return NULL;
+
+   struct gl_buffer_object *obj = _mesa_bufferobj_alloc(ctx, 0);
+   if (!obj)
+      return NULL;
+
+   obj->GLThreadInternal = true;
+
+   if (!_mesa_bufferobj_data(ctx, target, size, NULL, usage,
+                             GL_MAP_READ_BIT |
+                             GL_MAP_WRITE_BIT |
+                             GL_DYNAMIC_STORAGE_BIT,
+                             obj)) {
+      _mesa_delete_buffer_object(ctx, obj);
+      return NULL;
+   }
+
+   uint8_t *ptr = _mesa_bufferobj_map_range(ctx, 0, size,
+                                            GL_MAP_WRITE_BIT |
+                                            GL_MAP_UNSYNCHRONIZED_BIT |
+                                            MESA_MAP_THREAD_SAFE_BIT,
+                                            obj, MAP_GLTHREAD);
+   if (!ptr) {
+      _mesa_delete_buffer_object(ctx, obj);
+      return NULL;
+   }
+
+   memcpy(ptr, data, size);
+   return obj;
+}
+
 void
 _mesa_glthread_release_upload_buffer(struct gl_context *ctx)
 {
@@ -315,6 +358,11 @@ struct marshal_cmd_BufferData
    GLsizeiptr size;
    GLenum usage;
    const GLvoid *data_external_mem;
+   /* If set, the data is in this glthread upload buffer instead. */
+   struct gl_buffer_object *upload_buffer;
+   unsigned upload_offset;
+   /* If set, upload_buffer is the new data store rather than a copy source. */
+   bool upload_is_storage;
    bool data_null; /* If set, no data follows for "data" */
    bool named;
    bool ext_dsa;
@@ -330,6 +378,20 @@ _mesa_unmarshal_BufferData(struct gl_context *ctx,
    const GLenum usage = cmd->usage;
    const void *data;
 
+   if (cmd->upload_buffer) {
+      struct gl_buffer_object *upload_buffer = cmd->upload_buffer;
+
+      if (ctx->Dispatch.Current != ctx->Dispatch.ContextLost) {
+         _mesa_buffer_data_from_upload(ctx, target_or_name, size, usage,
+                                       cmd->named, cmd->ext_dsa,
+                                       upload_buffer, cmd->upload_offset,
+                                       cmd->upload_is_storage);
+      } else {
+         _mesa_reference_buffer_object(ctx, &upload_buffer, NULL);
+      }
+      return cmd->num_slots;
+   }
+
    if (cmd->data_null)
       data = NULL;
    else if (!cmd->named && target_or_name == GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD)
@@ -376,6 +438,34 @@ _mesa_marshal_BufferData_merged(GLuint target_or_name, GLsizeiptr size,
                        target_or_name == GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD;
    bool copy_data = data && !external_mem;
    size_t cmd_size = sizeof(struct marshal_cmd_BufferData) + (copy_data ? size : 0);
+   struct gl_buffer_object *upload_buffer = NULL;
+   unsigned upload_offset = 0;
+   bool upload_is_storage = false;
+
+   /* Data that doesn't fit in a batch is written to the new data store here
+    * if it can be mapped from this thread. Otherwise, it's copied to an
+    * upload buffer, which the GPU then copies to the new data store, like
+    * drivers do internally for buffers the CPU can't access. Either way,
+    * this avoids syncing with the driver thread for every large
+    * glBufferData.
+    */
+   if (copy_data && cmd_size > MARSHAL_MAX_CMD_SIZE &&
+       ctx->Const.AllowGLThreadBufferSubDataOpt &&
+       ctx->Dispatch.Current != ctx->Dispatch.ContextLost &&
+       size > 0 && size <= INT_MAX && !(named && target_or_name == 0)) {
+      upload_buffer = new_buffer_storage(ctx, named ? GL_NONE : target_or_name,
+                                         size, usage, data);
+      if (upload_buffer) {
+         upload_is_storage = true;
+      } else {
+         _mesa_glthread_upload(ctx, data, size, &upload_offset,
+                               &upload_buffer, NULL, 0);
+      }
+      if (upload_buffer) {
+         copy_data = false;
+         cmd_size = sizeof(struct marshal_cmd_BufferData);
+      }
+   }
 
    if (unlikely(size < 0 || size > INT_MAX || cmd_size > MARSHAL_MAX_CMD_SIZE ||
                 (named && target_or_name == 0))) {
@@ -401,6 +491,9 @@ _mesa_marshal_BufferData_merged(GLuint target_or_name, GLsizeiptr size,
    cmd->named = named;
    cmd->ext_dsa = ext_dsa;
    cmd->data_external_mem = data;
+   cmd->upload_buffer = upload_buffer;
+   cmd->upload_offset = upload_offset;
+   cmd->upload_is_storage = upload_is_storage;
 
    if (copy_data) {
       char *variable_data = (char *) (cmd + 1);
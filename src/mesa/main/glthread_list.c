@@ -61,7 +61,7 @@ _mesa_marshal_CallList(GLuint list)
    /* If the last call is CallList and there is enough space to append another list... */
    if (last &&
        _mesa_glthread_call_is_last(glthread, &last->cmd_base, last->num_slots) &&
-       glthread->used + 1 <= MARSHAL_MAX_CMD_SIZE / 8) {
+       glthread->used + 1 <= glthread->batch_limit) {
       STATIC_ASSERT(sizeof(*last) == 8);
 
       /* Add the list to the last call. */
@@ -30,6 +30,7 @@
 #include "hint.h"
 
 #include "mtypes.h"
+#include "shaderobj.h"
 #include "api_exec_decl.h"
 
 #include "pipe/p_screen.h"
@@ -139,6 +140,8 @@ _mesa_MaxShaderCompilerThreadsKHR(GLuint count)
 
    ctx->Hint.MaxShaderCompilerThreads = count;
 
+   _mesa_update_shader_compile_threads(ctx);
+
    struct pipe_screen *screen = ctx->screen;
    if (screen->set_max_shader_compiler_threads)
       screen->set_max_shader_compiler_threads(screen, count);
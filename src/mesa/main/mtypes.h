@@ -2245,6 +2245,7 @@ struct gl_ati_fragment_shader_state
 #define GLSL_CACHE_INFO 0x100 /**< Print debug information about shader cache */
 #define GLSL_CACHE_FALLBACK 0x200 /**< Force shader cache fallback paths */
 #define GLSL_SOURCE 0x400 /**< Only dump GLSL */
+#define GLSL_PP_TIME 0x800 /**< Report time spent preprocessing */
 
 
 /**
@@ -2432,6 +2433,13 @@ struct gl_shared_state
    /** Table of both gl_shader and gl_shader_program objects */
    struct _mesa_HashTable ShaderObjects;
 
+   /**
+    * Worker threads running the GLSL front-end for glCompileShader() in any
+    * of the contexts, as allowed by GL_KHR_parallel_shader_compile.  Created
+    * on first use, protected by Mutex.
+    */
+   struct util_queue ShaderCompileQueue;
+
    /* GL_EXT_framebuffer_object */
    struct _mesa_HashTable RenderBuffers;
    struct _mesa_HashTable FrameBuffers;
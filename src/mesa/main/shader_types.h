@@ -37,6 +37,7 @@
 #include "program/prog_parameter.h"
 #include "util/mesa-sha1.h"
 #include "util/mesa-blake3.h"
+#include "util/u_queue.h"
 #include "compiler/shader_info.h"
 #include "compiler/glsl/list.h"
 
@@ -165,6 +166,13 @@ struct gl_shader
 
    enum gl_compile_status CompileStatus;
 
+   /**
+    * Signalled once a glCompileShader() running on the share group's
+    * ShaderCompileQueue is done.  Everything the compile writes, including
+    * CompileStatus and InfoLog, must only be read after waiting for it.
+    */
+   struct util_queue_fence CompileFence;
+
    /** SHA1 of the pre-processed source used by the disk cache. */
    uint8_t disk_cache_sha1[SHA1_DIGEST_LENGTH];
    /** BLAKE3 of the original source before replacement, set by glShaderSource. */
@@ -38,6 +38,7 @@
 
 #include "util/glheader.h"
 #include "main/context.h"
+#include "main/debug_output.h"
 #include "draw_validate.h"
 #include "main/enums.h"
 #include "main/glspirv.h"
@@ -61,6 +62,8 @@
 #include "util/hash_table.h"
 #include "util/crc32.h"
 #include "util/os_file.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_debug.h"
 #include "util/list.h"
 #include "util/log.h"
 #include "util/perf/cpu_trace.h"
@@ -154,6 +157,8 @@ _mesa_get_shader_flags(void)
          flags |= GLSL_USE_PROG;
       if (strstr(env, "errors"))
          flags |= GLSL_REPORT_ERRORS;
+      if (strstr(env, "pp_time"))
+         flags |= GLSL_PP_TIME;
    }
 
    return flags;
@@ -247,6 +252,55 @@ _mesa_free_shader_state(struct gl_context *ctx)
    _mesa_reference_pipeline_object(ctx, &ctx->_Shader, NULL);
 
    assert(ctx->Shader.RefCount == 1);
+
+   /* The compile jobs of the context point to it. */
+   _mesa_finish_shader_compile_queue(ctx);
+}
+
+
+/**
+ * Wait for all glCompileShader() calls running on the worker threads of the
+ * context's share group.
+ */
+void
+_mesa_finish_shader_compile_queue(struct gl_context *ctx)
+{
+   struct gl_shared_state *shared = ctx->Shared;
+
+   if (!shared)
+      return;
+
+   simple_mtx_lock(&shared->Mutex);
+   const bool initialized =
+      util_queue_is_initialized(&shared->ShaderCompileQueue);
+   simple_mtx_unlock(&shared->Mutex);
+
+   if (initialized)
+      util_queue_finish(&shared->ShaderCompileQueue);
+}
+
+
+/**
+ * Apply glMaxShaderCompilerThreadsKHR() to the share group's compile
+ * threads.  Like the driver's threads, they're shared with the other
+ * contexts, so the last call wins.
+ */
+void
+_mesa_update_shader_compile_threads(struct gl_context *ctx)
+{
+   struct gl_shared_state *shared = ctx->Shared;
+
+   /* 0 makes glCompileShader() synchronous instead. */
+   if (ctx->Hint.MaxShaderCompilerThreads == 0)
+      return;
+
+   simple_mtx_lock(&shared->Mutex);
+   if (util_queue_is_initialized(&shared->ShaderCompileQueue)) {
+      util_queue_adjust_num_threads(&shared->ShaderCompileQueue,
+                                    ctx->Hint.MaxShaderCompilerThreads,
+                                    false);
+   }
+   simple_mtx_unlock(&shared->Mutex);
 }
 
 
@@ -1042,6 +1096,9 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       return;
    }
 
+   if (pname != GL_COMPLETION_STATUS_ARB)
+      util_queue_fence_wait(&shader->CompileFence);
+
    switch (pname) {
    case GL_SHADER_TYPE:
       *params = shader->Type;
@@ -1050,8 +1107,7 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       *params = shader->DeletePending;
       break;
    case GL_COMPLETION_STATUS_ARB:
-      /* _mesa_glsl_compile_shader is not offloaded to other threads. */
-      *params = GL_TRUE;
+      *params = util_queue_fence_is_signalled(&shader->CompileFence);
       return;
    case GL_COMPILE_STATUS:
       *params = shader->CompileStatus ? GL_TRUE : GL_FALSE;
@@ -1122,6 +1178,7 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   util_queue_fence_wait(&sh->CompileFence);
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -1158,6 +1215,8 @@ set_shader_source(struct gl_shader *sh, const GLchar *source,
 {
    assert(sh);
 
+   util_queue_fence_wait(&sh->CompileFence);
+
    /* The GL_ARB_gl_spirv spec adds the following to the end of the description
     * of ShaderSource:
     *
@@ -1193,8 +1252,94 @@ ensure_builtin_types(struct gl_context *ctx)
    }
 }
 
+/* Off by default until it has been run against real applications. */
+DEBUG_GET_ONCE_BOOL_OPTION(glsl_threaded_compile, "MESA_GLSL_THREADED_COMPILE",
+                           false)
+
+struct compile_shader_job {
+   struct gl_context *ctx;
+   struct gl_shader *sh;
+};
+
+static void
+compile_shader_job(void *data, void *gdata, int thread_index)
+{
+   struct compile_shader_job *job = data;
+
+   MESA_TRACE_FUNC();
+
+   _mesa_glsl_compile_shader(job->ctx, job->sh, NULL, false, false, false);
+}
+
+static void
+compile_shader_job_cleanup(void *data, void *gdata, int thread_index)
+{
+   free(data);
+}
+
+/**
+ * Return the share group's compile queue, creating it if needed, or NULL
+ * if the GLSL front-end for \p sh has to run inside glCompileShader().
+ */
+static struct util_queue *
+get_shader_compile_queue(struct gl_context *ctx, const struct gl_shader *sh)
+{
+   struct gl_shared_state *shared = ctx->Shared;
+
+   if (!debug_get_option_glsl_threaded_compile())
+      return NULL;
+
+   /* glMaxShaderCompilerThreadsKHR(0) asks for no parallel compiling. */
+   if (ctx->Hint.MaxShaderCompilerThreads == 0)
+      return NULL;
+
+   /* Keep MESA_GLSL debug output in API call order. */
+   if (ctx->Shader.Flags)
+      return NULL;
+
+   /* Compile errors and warnings are also reported through KHR_debug,
+    * whose callback must be called from the application's thread when the
+    * output is synchronous, and whose message log must keep API call order.
+    * Enabling the output waits for the compiles already queued.
+    */
+   if (ctx->Debug && _mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT))
+      return NULL;
+
+   /* Named strings can be changed as soon as glCompileShader() returns, so
+    * shaders including them are preprocessed synchronously.
+    */
+   if (strstr(sh->Source, "#include"))
+      return NULL;
+
+   simple_mtx_lock(&shared->Mutex);
+
+   if (!util_queue_is_initialized(&shared->ShaderCompileQueue)) {
+      /* Threads are only started as jobs pile up.  Like for the driver's
+       * threads, later glMaxShaderCompilerThreadsKHR() calls can't go above
+       * the number the queue was created with.
+       */
+      const unsigned num_threads =
+         MIN2(ctx->Hint.MaxShaderCompilerThreads,
+              util_get_cpu_caps()->nr_cpus);
+
+      util_queue_init(&shared->ShaderCompileQueue, "glsl", 32, num_threads,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL);
+   }
+
+   const bool initialized =
+      util_queue_is_initialized(&shared->ShaderCompileQueue);
+
+   simple_mtx_unlock(&shared->Mutex);
+
+   return initialized ? &shared->ShaderCompileQueue : NULL;
+}
+
 /**
  * Compile a shader.
+ *
+ * The GLSL front-end (preprocessor, parser, AST to IR and GLSL to NIR) runs
+ * on the share group's worker threads when possible, and everything reading
+ * the results waits for sh->CompileFence.
  */
 void
 _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
@@ -1202,6 +1347,8 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
    if (!sh)
       return;
 
+   util_queue_fence_wait(&sh->CompileFence);
+
    /* The GL_ARB_gl_spirv spec says:
     *
     *    "Add a new error for the CompileShader command:
@@ -1220,7 +1367,7 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
        */
       sh->CompileStatus = COMPILE_FAILURE;
    } else {
-      if (ctx->_Shader->Flags & (GLSL_DUMP | GLSL_SOURCE)) {
+      if (ctx->Shader.Flags & (GLSL_DUMP | GLSL_SOURCE)) {
          _mesa_log("GLSL source for %s shader %d:\n",
                  _mesa_shader_stage_to_string(sh->Stage), sh->Name);
          _mesa_log_direct(sh->Source);
@@ -1228,25 +1375,36 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
 
       ensure_builtin_types(ctx);
 
+      struct util_queue *queue = get_shader_compile_queue(ctx, sh);
+      struct compile_shader_job *job =
+         queue ? malloc(sizeof(*job)) : NULL;
+      if (job) {
+         job->ctx = ctx;
+         job->sh = sh;
+         util_queue_add_job(queue, job, &sh->CompileFence,
+                            compile_shader_job, compile_shader_job_cleanup, 0);
+         return;
+      }
+
       /* this call will set the shader->CompileStatus field to indicate if
        * compilation was successful.
        */
       _mesa_glsl_compile_shader(ctx, sh, NULL, false, false, false);
 
-      if (ctx->_Shader->Flags & GLSL_LOG) {
+      if (ctx->Shader.Flags & GLSL_LOG) {
          _mesa_write_shader_to_file(sh);
       }
    }
 
    if (!sh->CompileStatus) {
-      if (ctx->_Shader->Flags & GLSL_DUMP_ON_ERROR) {
+      if (ctx->Shader.Flags & GLSL_DUMP_ON_ERROR) {
          _mesa_log("GLSL source for %s shader %d:\n",
                  _mesa_shader_stage_to_string(sh->Stage), sh->Name);
          _mesa_log("%s\n", sh->Source);
          _mesa_log("Info Log:\n%s\n", sh->InfoLog);
       }
 
-      if (ctx->_Shader->Flags & GLSL_REPORT_ERRORS) {
+      if (ctx->Shader.Flags & GLSL_REPORT_ERRORS) {
          _mesa_debug(ctx, "Error compiling shader %u:\n%s\n",
                      sh->Name, sh->InfoLog);
       }
@@ -1313,6 +1471,13 @@ link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
 
    ensure_builtin_types(ctx);
 
+   /* Only the compiles overlap with the application.  Linking still runs
+    * here because st_link_shader() updates context state, e.g. the current
+    * program when relinking it.
+    */
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      util_queue_fence_wait(&shProg->Shaders[i]->CompileFence);
+
    FLUSH_VERTICES(ctx, 0, 0);
    st_link_shader(ctx, shProg);
 
@@ -1393,7 +1558,7 @@ link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
 #endif
 
    if (shProg->data->LinkStatus == LINKING_FAILURE &&
-       (ctx->_Shader->Flags & GLSL_REPORT_ERRORS)) {
+       (ctx->Shader.Flags & GLSL_REPORT_ERRORS)) {
       _mesa_debug(ctx, "Error linking program %u:\n%s\n",
                   shProg->Name, shProg->data->InfoLog);
    }
@@ -2202,7 +2367,7 @@ use_program(GLuint program, bool no_error)
          }
 
          /* debug code */
-         if (ctx->_Shader->Flags & GLSL_USE_PROG) {
+         if (ctx->Shader.Flags & GLSL_USE_PROG) {
             print_shader_info(shProg);
          }
       }
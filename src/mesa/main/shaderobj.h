@@ -51,6 +51,12 @@ _mesa_init_shader_state(struct gl_context * ctx);
 extern void
 _mesa_free_shader_state(struct gl_context *ctx);
 
+extern void
+_mesa_finish_shader_compile_queue(struct gl_context *ctx);
+
+extern void
+_mesa_update_shader_compile_threads(struct gl_context *ctx);
+
 
 extern void
 _mesa_reference_shader(struct gl_context *ctx, struct gl_shader **ptr,
@@ -352,6 +352,10 @@ free_shared_state(struct gl_context *ctx, struct gl_shared_state *shared)
 
    _mesa_HashWalk(&shared->ShaderObjects, free_shader_program_data_cb, ctx);
    _mesa_DeinitHashTable(&shared->ShaderObjects, delete_shader_cb, ctx);
+
+   /* Deleting the shaders waited for their compiles. */
+   if (util_queue_is_initialized(&shared->ShaderCompileQueue))
+      util_queue_destroy(&shared->ShaderCompileQueue);
    _mesa_DeinitHashTable(&shared->Programs, delete_program_cb, ctx);
 
    if (shared->DefaultVertexProgram)
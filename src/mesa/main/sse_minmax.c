@@ -30,66 +30,85 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
-{
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
-
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
-   }
-
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      alignas(16) unsigned max_arr[4];
-      alignas(16) unsigned min_arr[4];
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
-
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
-
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
-      }
-      i = vec_count;
-   }
-
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
-   }
-
-   *min_index = min_ui;
-   *max_index = max_ui;
+/* Generates a function computing the min and max of an array of indices of
+ * type T, skipping any index equal to the restart index.
+ *
+ * Restart indices are replaced by ~0 when computing the minimum and by 0
+ * when computing the maximum, so they don't affect either.  An array with
+ * no index besides restart indices gives min > max, which is turned into
+ * the ~0U/0 result of the scalar loops.
+ */
+#define MIN_MAX_FUNC(name, T, lanes, set1, cmpeq, min, max)                 \
+void                                                                        \
+name(const T *indices, unsigned *min_index, unsigned *max_index,            \
+     const unsigned count, bool restart, unsigned restart_index)            \
+{                                                                           \
+   const T restart_value = (T)restart_index;                                \
+   unsigned min_val = ~0U;                                                  \
+   unsigned max_val = 0;                                                    \
+   unsigned i = 0;                                                          \
+                                                                            \
+   /* A restart index that doesn't fit in T never matches. */               \
+   restart = restart && restart_index == restart_value;                     \
+                                                                            \
+   /* Even a single vector is faster than the scalar loop, see the         \
+    * MinMaxIndex benchmark in main/tests.                                  \
+    */                                                                      \
+   if (count >= (lanes)) {                                                  \
+      alignas(16) T max_arr[lanes];                                         \
+      alignas(16) T min_arr[lanes];                                         \
+      const unsigned vec_count = count & ~((lanes) - 1);                    \
+      __m128i max4 = _mm_setzero_si128();                                   \
+      __m128i min4 = _mm_set1_epi32(~0);                                    \
+                                                                            \
+      if (restart) {                                                        \
+         const __m128i restart4 = set1(restart_value);                      \
+         for (; i < vec_count; i += (lanes)) {                              \
+            const __m128i v =                                               \
+               _mm_loadu_si128((const __m128i *)&indices[i]);               \
+            const __m128i is_restart = cmpeq(v, restart4);                  \
+            max4 = max(_mm_andnot_si128(is_restart, v), max4);              \
+            min4 = min(_mm_or_si128(is_restart, v), min4);                  \
+         }                                                                  \
+      } else {                                                              \
+         for (; i < vec_count; i += (lanes)) {                              \
+            const __m128i v =                                               \
+               _mm_loadu_si128((const __m128i *)&indices[i]);               \
+            max4 = max(v, max4);                                            \
+            min4 = min(v, min4);                                            \
+         }                                                                  \
+      }                                                                     \
+                                                                            \
+      _mm_store_si128((__m128i *)max_arr, max4);                            \
+      _mm_store_si128((__m128i *)min_arr, min4);                            \
+                                                                            \
+      for (unsigned j = 0; j < (lanes); j++) {                              \
+         if (max_arr[j] > max_val)                                          \
+            max_val = max_arr[j];                                           \
+         if (min_arr[j] < min_val)                                          \
+            min_val = min_arr[j];                                           \
+      }                                                                     \
+   }                                                                        \
+                                                                            \
+   for (; i < count; i++) {                                                 \
+      if (restart && indices[i] == restart_value)                           \
+         continue;                                                          \
+      if (indices[i] > max_val)                                             \
+         max_val = indices[i];                                              \
+      if (indices[i] < min_val)                                             \
+         min_val = indices[i];                                              \
+   }                                                                        \
+                                                                            \
+   if (min_val > max_val)                                                   \
+      min_val = ~0U;                                                        \
+                                                                            \
+   *min_index = min_val;                                                    \
+   *max_index = max_val;                                                    \
 }
+
+MIN_MAX_FUNC(_mesa_uint_array_min_max, unsigned, 4,
+             _mm_set1_epi32, _mm_cmpeq_epi32, _mm_min_epu32, _mm_max_epu32)
+MIN_MAX_FUNC(_mesa_ushort_array_min_max, uint16_t, 8,
+             _mm_set1_epi16, _mm_cmpeq_epi16, _mm_min_epu16, _mm_max_epu16)
+MIN_MAX_FUNC(_mesa_ubyte_array_min_max, uint8_t, 16,
+             _mm_set1_epi8, _mm_cmpeq_epi8, _mm_min_epu8, _mm_max_epu8)
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "main/mtypes.h"
+extern "C" {
+#include "main/dlist.h"
+#include "vbo/vbo_save.h"
+}
+
+namespace {
+
+struct draw {
+   unsigned mode, start, count;
+
+   bool operator==(const draw &o) const
+   {
+      return mode == o.mode && start == o.start && count == o.count;
+   }
+};
+
+struct prim {
+   unsigned mode, start, count;
+   bool begin, end;
+
+   bool operator==(const prim &o) const
+   {
+      return mode == o.mode && start == o.start && count == o.count &&
+             begin == o.begin && end == o.end;
+   }
+};
+
+/* A vertex list as built by vbo_save_api.c, drawing from a shared VAO. */
+class vertex_list {
+public:
+   vertex_list(const std::vector<prim> &prims, unsigned wrap_count = 0)
+   {
+      memset(&node, 0, sizeof(node));
+      node.cold = (decltype(node.cold))calloc(1, sizeof(*node.cold));
+      for (unsigned i = 0; i < VP_MODE_MAX; i++)
+         node.cold->VAO[i] = &vao;
+
+      node.cold->prims =
+         (struct _mesa_prim *)calloc(prims.size(), sizeof(struct _mesa_prim));
+      node.cold->prim_count = prims.size();
+      node.cold->wrap_count = wrap_count;
+      node.cold->min_index = ~0u;
+      for (unsigned i = 0; i < prims.size(); i++) {
+         node.cold->prims[i].mode = prims[i].mode;
+         node.cold->prims[i].start = prims[i].start;
+         node.cold->prims[i].count = prims[i].count;
+         node.cold->prims[i].begin = prims[i].begin;
+         node.cold->prims[i].end = prims[i].end;
+         node.cold->vertex_count += prims[i].count;
+         node.cold->min_index = MIN2(node.cold->min_index, prims[i].start);
+         node.cold->max_index = MAX2(node.cold->max_index,
+                                     prims[i].start + prims[i].count - 1);
+      }
+      node.draw_begins = prims[0].begin;
+
+      node.num_draws = prims.size();
+      if (node.num_draws == 1) {
+         node.start_count.start = prims[0].start;
+         node.start_count.count = prims[0].count;
+         node.cold->info.mode = (enum mesa_prim)prims[0].mode;
+         node.mode = prims[0].mode;
+      } else {
+         node.start_counts = (struct pipe_draw_start_count_bias *)
+            calloc(prims.size(), sizeof(struct pipe_draw_start_count_bias));
+         node.modes = (uint8_t *)malloc(prims.size());
+         for (unsigned i = 0; i < prims.size(); i++) {
+            node.start_counts[i].start = prims[i].start;
+            node.start_counts[i].count = prims[i].count;
+            node.modes[i] = prims[i].mode;
+         }
+      }
+   }
+
+   ~vertex_list()
+   {
+      if (node.num_draws > 1) {
+         free(node.start_counts);
+         free(node.modes);
+      }
+      free(node.cold->prims);
+      free(node.cold->current_data);
+      free(node.cold);
+   }
+
+   /* The draws vbo_save_playback_vertex_list submits. */
+   std::vector<draw> draws() const
+   {
+      std::vector<draw> result;
+      const struct pipe_draw_start_count_bias *sc =
+         node.num_draws > 1 ? node.start_counts : &node.start_count;
+
+      for (unsigned i = 0; i < node.num_draws; i++) {
+         result.push_back({node.modes ? node.modes[i] :
+                                        (unsigned)node.cold->info.mode,
+                           sc[i].start, sc[i].count});
+      }
+      return result;
+   }
+
+   /* The primitives _vbo_loopback_vertex_list replays. */
+   std::vector<prim> prims() const
+   {
+      std::vector<prim> result;
+
+      for (unsigned i = 0; i < node.cold->prim_count; i++) {
+         const struct _mesa_prim *p = &node.cold->prims[i];
+         unsigned skip = p->begin ? 0 : node.cold->wrap_count;
+
+         result.push_back({p->mode, p->start + skip, p->count - skip,
+                           p->begin, p->end});
+      }
+      return result;
+   }
+
+   struct vbo_save_vertex_list node;
+   static struct gl_vertex_array_object vao;
+};
+
+struct gl_vertex_array_object vertex_list::vao;
+
+template<typename T> static std::vector<T>
+concat(std::vector<T> a, const std::vector<T> &b)
+{
+   a.insert(a.end(), b.begin(), b.end());
+   return a;
+}
+
+} /* anonymous namespace */
+
+TEST(dlist_merge, merged_lists_draw_the_same_prims)
+{
+   vertex_list a({{GL_TRIANGLES, 0, 6, true, true},
+                  {GL_LINES, 6, 4, true, true}});
+   vertex_list b({{GL_TRIANGLES, 10, 3, true, true}});
+   const std::vector<draw> draws = concat(a.draws(), b.draws());
+   const std::vector<prim> prims = concat(a.prims(), b.prims());
+
+   ASSERT_TRUE(_mesa_dlist_merge_vertex_list_draws(&a.node, &b.node));
+   EXPECT_EQ(a.draws(), draws);
+   EXPECT_EQ(a.prims(), prims);
+   EXPECT_EQ(a.node.cold->vertex_count, 13u);
+   EXPECT_EQ(a.node.cold->min_index, 0u);
+   EXPECT_EQ(a.node.cold->max_index, 12u);
+}
+
+TEST(dlist_merge, single_draws_with_the_same_mode)
+{
+   vertex_list a({{GL_TRIANGLES, 0, 3, true, true}});
+   vertex_list b({{GL_TRIANGLES, 3, 3, true, true}});
+   const std::vector<draw> draws = concat(a.draws(), b.draws());
+
+   ASSERT_TRUE(_mesa_dlist_merge_vertex_list_draws(&a.node, &b.node));
+   EXPECT_EQ(a.draws(), draws);
+   EXPECT_EQ(a.node.modes, nullptr);
+   EXPECT_EQ(a.node.cold->info.mode, (unsigned)GL_TRIANGLES);
+}
+
+TEST(dlist_merge, continued_primitive_is_not_merged)
+{
+   /* A triangle strip spanning three lists: a and b both continue it, with
+    * a different number of wrapped vertices.  Replaying b's part with a's
+    * wrap count would drop or duplicate vertices.
+    */
+   vertex_list a({{GL_TRIANGLE_STRIP, 0, 6, false, false}}, 2);
+   vertex_list b({{GL_TRIANGLE_STRIP, 6, 5, false, true}}, 3);
+   const std::vector<draw> draws = a.draws();
+   const std::vector<prim> prims = a.prims();
+
+   EXPECT_FALSE(_mesa_dlist_merge_vertex_list_draws(&a.node, &b.node));
+   EXPECT_EQ(a.draws(), draws);
+   EXPECT_EQ(a.prims(), prims);
+}
+
+TEST(dlist_merge, continuation_is_not_merged_into)
+{
+   vertex_list a({{GL_LINE_STRIP, 1, 4, false, true}}, 1);
+   vertex_list b({{GL_LINES, 5, 2, true, true}});
+
+   EXPECT_FALSE(_mesa_dlist_merge_vertex_list_draws(&a.node, &b.node));
+}
+
+TEST(dlist_merge, different_vertex_buffers_are_not_merged)
+{
+   static struct gl_vertex_array_object other_vao;
+   vertex_list a({{GL_POINTS, 0, 1, true, true}});
+   vertex_list b({{GL_POINTS, 1, 1, true, true}});
+
+   b.node.cold->VAO[VP_MODE_SHADER] = &other_vao;
+   EXPECT_FALSE(_mesa_dlist_merge_vertex_list_draws(&a.node, &b.node));
+}
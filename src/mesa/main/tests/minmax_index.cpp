@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2026 agent
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "util/os_time.h"
+#include "vbo/vbo.h"
+
+template<typename T> static void
+reference_min_max(const T *indices, unsigned count, bool restart,
+                  unsigned restart_index, unsigned *min_index,
+                  unsigned *max_index)
+{
+   unsigned min_val = ~0U, max_val = 0;
+
+   for (unsigned i = 0; i < count; i++) {
+      if (restart && indices[i] == restart_index)
+         continue;
+      min_val = MIN2(min_val, indices[i]);
+      max_val = MAX2(max_val, indices[i]);
+   }
+
+   *min_index = min_val;
+   *max_index = max_val;
+}
+
+template<typename T> static std::vector<T>
+make_indices(unsigned count, unsigned seed, unsigned restart_every,
+             unsigned restart_index)
+{
+   std::vector<T> indices(count);
+
+   for (unsigned i = 0; i < count; i++) {
+      seed = seed * 1103515245 + 12345;
+      indices[i] = (T)(seed >> 8);
+      if (restart_every && i % restart_every == restart_every - 1)
+         indices[i] = (T)restart_index;
+   }
+
+   return indices;
+}
+
+template<typename T> static void
+check_min_max(unsigned count, unsigned offset, bool restart,
+              unsigned restart_index, unsigned restart_every)
+{
+   std::vector<T> indices =
+      make_indices<T>(count + offset, count, restart_every, restart_index);
+   unsigned ref_min, ref_max, min_index, max_index;
+
+   reference_min_max(indices.data() + offset, count, restart, restart_index,
+                     &ref_min, &ref_max);
+   vbo_get_minmax_index_mapped(count, sizeof(T), restart_index, restart,
+                               indices.data() + offset,
+                               &min_index, &max_index);
+
+   EXPECT_EQ(ref_min, min_index) << "count " << count << " offset " << offset;
+   EXPECT_EQ(ref_max, max_index) << "count " << count << " offset " << offset;
+}
+
+template<typename T> static void
+check_all(unsigned type_max)
+{
+   const unsigned restart_indices[] = { type_max, 0, 7, ~0U };
+
+   for (unsigned count = 0; count < 80; count++) {
+      for (unsigned offset = 0; offset < 4; offset++) {
+         check_min_max<T>(count, offset, false, type_max, 0);
+
+         for (unsigned r = 0; r < ARRAY_SIZE(restart_indices); r++) {
+            check_min_max<T>(count, offset, true, restart_indices[r], 3);
+            check_min_max<T>(count, offset, true, restart_indices[r], 1);
+         }
+      }
+   }
+
+   check_min_max<T>(100000, 1, false, type_max, 0);
+   check_min_max<T>(100000, 1, true, type_max, 5);
+}
+
+TEST(MinMaxIndex, UnsignedInt)
+{
+   check_all<uint32_t>(UINT32_MAX);
+}
+
+TEST(MinMaxIndex, UnsignedShort)
+{
+   check_all<uint16_t>(UINT16_MAX);
+}
+
+TEST(MinMaxIndex, UnsignedByte)
+{
+   check_all<uint8_t>(UINT8_MAX);
+}
+
+/* Times vbo_get_minmax_index_mapped() against a scalar loop for every index
+ * size, with and without primitive restart.  Run it with
+ * --gtest_also_run_disabled_tests.
+ */
+template<typename T> static void
+bench_min_max(unsigned count, bool restart)
+{
+   const unsigned restart_index = (T)~0U;
+   std::vector<T> indices =
+      make_indices<T>(count, 1, restart ? 64 : 0, restart_index);
+   const unsigned iterations = MAX2(100000000 / count, 1);
+   unsigned min_index, max_index;
+   unsigned sum = 0;
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++) {
+      reference_min_max(indices.data(), count, restart, restart_index,
+                        &min_index, &max_index);
+      sum += min_index + max_index;
+   }
+   const int64_t scalar_ns = os_time_get_nano() - start;
+
+   start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++) {
+      vbo_get_minmax_index_mapped(count, sizeof(T), restart_index, restart,
+                                  indices.data(), &min_index, &max_index);
+      sum += min_index + max_index;
+   }
+   const int64_t vbo_ns = os_time_get_nano() - start;
+
+   printf("%u-bit %-10s %8u indices: scalar %8.1f ns, vbo %8.1f ns (%u)\n",
+          (unsigned)(8 * sizeof(T)), restart ? "restart" : "no restart",
+          count, (double)scalar_ns / iterations, (double)vbo_ns / iterations,
+          sum & 1);
+}
+
+TEST(MinMaxIndex, DISABLED_Benchmark)
+{
+   const unsigned counts[] = { 16, 256, 4096, 65536, 1 << 20 };
+
+   for (unsigned c = 0; c < ARRAY_SIZE(counts); c++) {
+      for (unsigned restart = 0; restart < 2; restart++) {
+         bench_min_max<uint32_t>(counts[c], restart);
+         bench_min_max<uint16_t>(counts[c], restart);
+         bench_min_max<uint8_t>(counts[c], restart);
+      }
+   }
+}
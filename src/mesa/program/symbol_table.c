@@ -25,10 +25,14 @@
 #include "main/errors.h"
 #include "symbol_table.h"
 #include "util/hash_table.h"
+#include "util/ralloc.h"
 #include "util/u_string.h"
 
 struct symbol {
-   /** Symbol name. */
+   /**
+    * Symbol name.  It's owned by the outermost symbol with this name, which
+    * stores it in \c short_name or allocates it with malloc.
+    */
    char *name;
 
     /**
@@ -54,6 +58,9 @@ struct symbol {
      * Arbitrary user supplied data.
      */
     void *data;
+
+    /** Storage for names that are short enough, which most are. */
+    char short_name[24];
 };
 
 
@@ -81,6 +88,25 @@ struct _mesa_symbol_table {
 
     /** Current scope depth. */
     unsigned depth;
+
+    /**
+     * Allocator for scopes and symbols.
+     *
+     * Nothing is freed until the table is destroyed, but popped scopes and
+     * symbols are reused through \c free_scopes and \c free_symbols, so the
+     * memory used is bounded by the largest number of scopes and symbols
+     * that are in the table at the same time.
+     */
+    linear_ctx *linalloc;
+
+    /** Scopes that have been popped, available for reuse. */
+    struct scope_level *free_scopes;
+
+    /**
+     * Symbols that have been popped, available for reuse, linked through
+     * \c symbol::next_with_same_scope.
+     */
+    struct symbol *free_symbols;
 };
 
 void
@@ -92,7 +118,8 @@ _mesa_symbol_table_pop_scope(struct _mesa_symbol_table *table)
     table->current_scope = scope->next;
     table->depth--;
 
-    free(scope);
+    scope->next = table->free_scopes;
+    table->free_scopes = scope;
 
     while (sym != NULL) {
         struct symbol *const next = sym->next_with_same_scope;
@@ -105,9 +132,12 @@ _mesa_symbol_table_pop_scope(struct _mesa_symbol_table *table)
            hte->data = sym->next_with_same_name;
         } else {
            _mesa_hash_table_remove(table->ht, hte);
+           if (sym->name != sym->short_name)
+              free(sym->name);
         }
 
-        free(sym);
+        sym->next_with_same_scope = table->free_symbols;
+        table->free_symbols = sym;
         sym = next;
     }
 }
@@ -116,12 +146,18 @@ _mesa_symbol_table_pop_scope(struct _mesa_symbol_table *table)
 void
 _mesa_symbol_table_push_scope(struct _mesa_symbol_table *table)
 {
-    struct scope_level *const scope = calloc(1, sizeof(*scope));
-    if (scope == NULL) {
-       _mesa_error_no_memory(__func__);
-       return;
+    struct scope_level *scope = table->free_scopes;
+    if (scope != NULL) {
+       table->free_scopes = scope->next;
+    } else {
+       scope = linear_alloc(table->linalloc, struct scope_level);
+       if (scope == NULL) {
+          _mesa_error_no_memory(__func__);
+          return;
+       }
     }
 
+    scope->symbols = NULL;
     scope->next = table->current_scope;
     table->current_scope = scope;
     table->depth++;
@@ -183,10 +219,15 @@ _mesa_symbol_table_add_symbol(struct _mesa_symbol_table *table,
    if (sym && sym->depth == table->depth)
       return -1;
 
-   new_sym = calloc(1, sizeof(*sym) + (sym ? 0 : (strlen(name) + 1)));
-   if (new_sym == NULL) {
-      _mesa_error_no_memory(__func__);
-      return -1;
+   new_sym = table->free_symbols;
+   if (new_sym != NULL) {
+      table->free_symbols = new_sym->next_with_same_scope;
+   } else {
+      new_sym = linear_alloc(table->linalloc, struct symbol);
+      if (new_sym == NULL) {
+         _mesa_error_no_memory(__func__);
+         return -1;
+      }
    }
 
    if (sym) {
@@ -196,8 +237,23 @@ _mesa_symbol_table_add_symbol(struct _mesa_symbol_table *table,
 
       entry->data = new_sym;
    } else {
-      new_sym->name = (char *)(new_sym + 1);
-      strcpy(new_sym->name, name);
+      const size_t len = strlen(name);
+
+      if (len < sizeof(new_sym->short_name)) {
+         memcpy(new_sym->short_name, name, len + 1);
+         new_sym->name = new_sym->short_name;
+      } else {
+         new_sym->name = strdup(name);
+      }
+
+      if (new_sym->name == NULL) {
+         new_sym->next_with_same_scope = table->free_symbols;
+         table->free_symbols = new_sym;
+         _mesa_error_no_memory(__func__);
+         return -1;
+      }
+
+      new_sym->next_with_same_name = NULL;
 
       _mesa_hash_table_insert_pre_hashed(table->ht, hash, new_sym->name, new_sym);
    }
@@ -229,11 +285,12 @@ _mesa_symbol_table_replace_symbol(struct _mesa_symbol_table *table,
 struct _mesa_symbol_table *
 _mesa_symbol_table_ctor(void)
 {
-    struct _mesa_symbol_table *table = calloc(1, sizeof(*table));
+    struct _mesa_symbol_table *table = rzalloc(NULL, struct _mesa_symbol_table);
 
     if (table != NULL) {
-       table->ht = _mesa_hash_table_create(NULL, _mesa_hash_string,
+       table->ht = _mesa_hash_table_create(table, _mesa_hash_string,
                                            _mesa_key_string_equal);
+       table->linalloc = linear_context(table);
 
        _mesa_symbol_table_push_scope(table);
     }
@@ -245,22 +302,18 @@ _mesa_symbol_table_ctor(void)
 void
 _mesa_symbol_table_dtor(struct _mesa_symbol_table *table)
 {
-   /* Free all the scopes and symbols left in the table.  This is like repeated
-    * _mesa_symbol_table_pop_scope(), but not maintining the hash table as we
-    * blow it all away.
+   /* Free the names that don't live in the outermost symbol with that name.
+    * The hash table, scopes and symbols are all children of the table.
     */
-   while (table->current_scope) {
-      struct scope_level *scope = table->current_scope;
-      table->current_scope = scope->next;
-
-      while (scope->symbols) {
-         struct symbol *sym = scope->symbols;
-         scope->symbols = sym->next_with_same_scope;
-         free(sym);
-      }
-      free(scope);
+   hash_table_foreach(table->ht, entry) {
+      struct symbol *sym = entry->data;
+
+      while (sym->next_with_same_name)
+         sym = sym->next_with_same_name;
+
+      if (sym->name != sym->short_name)
+         free(sym->name);
    }
 
-   _mesa_hash_table_destroy(table->ht, NULL);
-   free(table);
+   ralloc_free(table);
 }
@@ -34,6 +34,7 @@
 
 #include "st_context.h"
 #include "st_atom.h"
+#include "st_util.h"
 
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
@@ -226,7 +227,8 @@ fix_xrgb_alpha(enum pipe_blendfactor factor)
 void
 st_update_blend( struct st_context *st )
 {
-   struct pipe_blend_state *blend = &st->state.blend;
+   struct pipe_blend_state blend_state;
+   struct pipe_blend_state *blend = &blend_state;
    const struct gl_context *ctx = st->ctx;
    unsigned num_cb = st->state.fb_num_cb;
    unsigned num_state = 1;
@@ -351,6 +353,10 @@ st_update_blend( struct st_context *st )
          GL_ALPHA_TO_COVERAGE_DITHER_DISABLE_NV;
    }
 
+   if (st_atom_cso_unchanged(st, ST_NEW_BLEND_INDEX, &st->state.blend,
+                             blend, sizeof(*blend)))
+      return;
+
    cso_set_blend(st->cso_context, blend);
 }
 
@@ -37,6 +37,7 @@
 
 #include "st_context.h"
 #include "st_atom.h"
+#include "st_util.h"
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
 #include "cso_cache/cso_context.h"
@@ -76,7 +77,8 @@ gl_stencil_op_to_pipe(GLenum func)
 void
 st_update_depth_stencil_alpha(struct st_context *st)
 {
-   struct pipe_depth_stencil_alpha_state *dsa = &st->state.depth_stencil;
+   struct pipe_depth_stencil_alpha_state dsa_state;
+   struct pipe_depth_stencil_alpha_state *dsa = &dsa_state;
    struct pipe_stencil_ref sr;
    struct gl_context *ctx = st->ctx;
 
@@ -135,6 +137,8 @@ st_update_depth_stencil_alpha(struct st_context *st)
       dsa->alpha_ref_value = ctx->Color.AlphaRefUnclamped;
    }
 
-   cso_set_depth_stencil_alpha(st->cso_context, dsa);
+   if (!st_atom_cso_unchanged(st, ST_NEW_DSA_INDEX, &st->state.depth_stencil,
+                              dsa, sizeof(*dsa)))
+      cso_set_depth_stencil_alpha(st->cso_context, dsa);
    cso_set_stencil_ref(st->cso_context, sr);
 }
@@ -66,7 +66,8 @@ void
 st_update_rasterizer(struct st_context *st)
 {
    struct gl_context *ctx = st->ctx;
-   struct pipe_rasterizer_state *raster = &st->state.rasterizer;
+   struct pipe_rasterizer_state raster_state;
+   struct pipe_rasterizer_state *raster = &raster_state;
    const struct gl_program *fragProg = ctx->FragmentProgram._Current;
 
    memset(raster, 0, sizeof(*raster));
@@ -326,5 +327,9 @@ st_update_rasterizer(struct st_context *st)
    raster->subpixel_precision_x = ctx->SubpixelPrecisionBias[0];
    raster->subpixel_precision_y = ctx->SubpixelPrecisionBias[1];
 
+   if (st_atom_cso_unchanged(st, ST_NEW_RASTERIZER_INDEX, &st->state.rasterizer,
+                             raster, sizeof(*raster)))
+      return;
+
    cso_set_rasterizer(st->cso_context, raster);
 }
@@ -334,6 +334,9 @@ st_context_free_zombie_objects(struct st_context *st)
 static void
 st_destroy_context_priv(struct st_context *st, bool destroy_pipe)
 {
+   if (ST_DEBUG & DEBUG_ATOM_STATS)
+      st_print_atom_stats(st);
+
    st_destroy_draw(st);
    st_destroy_clear(st);
    st_destroy_bitmap(st);
@@ -255,6 +255,18 @@ struct st_context
          PIPE_MAX_SAMPLE_LOCATION_GRID_SIZE * 32];
    } state;
 
+   /**
+    * Atoms (as 1 << ST_NEW_*_INDEX) whose CSO in st->state above is the one
+    * bound in cso_context, see st_atom_cso_unchanged.
+    */
+   uint64_t atom_cso_valid;
+
+   /** How often atoms found their CSO unchanged, for ST_DEBUG=atomstats. */
+   struct {
+      uint64_t hits;
+      uint64_t misses;
+   } atom_stats[ST_NUM_ATOMS];
+
    /** This masks out unused shader resources. Only valid in draw calls. */
    uint64_t active_states;
 
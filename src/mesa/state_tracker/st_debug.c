@@ -52,6 +52,7 @@ static const struct debug_named_value st_debug_flags[] = {
    { "wf",       DEBUG_WIREFRAME, NULL },
    { "gremedy",  DEBUG_GREMEDY, "Enable GREMEDY debug extensions" },
    { "noreadpixcache", DEBUG_NOREADPIXCACHE, NULL },
+   { "atomstats", DEBUG_ATOM_STATS, "Print how often state atoms found their CSO unchanged" },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -63,3 +64,29 @@ st_debug_init(void)
 {
    ST_DEBUG = debug_get_option_st_debug();
 }
+
+
+/**
+ * Print how often each state atom that checks whether its CSO changed
+ * could skip binding it.
+ */
+void
+st_print_atom_stats(const struct st_context *st)
+{
+   static const char *names[] = {
+#define ST_STATE(FLAG, st_update) #st_update,
+#include "st_atom_list.h"
+#undef ST_STATE
+   };
+
+   for (unsigned i = 0; i < ST_NUM_ATOMS; i++) {
+      const uint64_t hits = st->atom_stats[i].hits;
+      const uint64_t total = hits + st->atom_stats[i].misses;
+
+      if (!total)
+         continue;
+
+      debug_printf("%s: %" PRIu64 " unchanged out of %" PRIu64 " (%.1f%%)\n",
+                   names[i], hits, total, 100.0 * hits / total);
+   }
+}
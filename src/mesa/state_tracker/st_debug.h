@@ -41,11 +41,14 @@ struct st_context;
 #define DEBUG_WIREFRAME       BITFIELD_BIT(4)
 #define DEBUG_GREMEDY         BITFIELD_BIT(5)
 #define DEBUG_NOREADPIXCACHE  BITFIELD_BIT(6)
+#define DEBUG_ATOM_STATS      BITFIELD_BIT(7)
 
 extern int ST_DEBUG;
 
 void st_debug_init( void );
 
+void st_print_atom_stats(const struct st_context *st);
+
 static inline void
 ST_DBG( unsigned flag, const char *fmt, ... )
 {
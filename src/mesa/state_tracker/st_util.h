@@ -65,6 +65,31 @@ st_invalidate_readpix_cache(struct st_context *st)
    }
 }
 
+/**
+ * Return whether the CSO that a state atom has just built is the same as
+ * the one it bound last time, in which case the atom can skip hashing it
+ * and looking it up in the CSO cache again. Otherwise, the new state is
+ * copied to \p last and the atom must bind it.
+ *
+ * Both states must be memset to 0 before being filled in, so that the
+ * padding compares equal.
+ */
+static inline bool
+st_atom_cso_unchanged(struct st_context *st, unsigned atom_index,
+                      void *last, const void *state, size_t size)
+{
+   if (st->atom_cso_valid & BITFIELD64_BIT(atom_index) &&
+       !memcmp(last, state, size)) {
+      st->atom_stats[atom_index].hits++;
+      return true;
+   }
+
+   memcpy(last, state, size);
+   st->atom_cso_valid |= BITFIELD64_BIT(atom_index);
+   st->atom_stats[atom_index].misses++;
+   return false;
+}
+
 static inline bool
 st_user_clip_planes_enabled(struct gl_context *ctx)
 {
@@ -234,6 +234,27 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
                             const void *indices,
                             unsigned *min_index, unsigned *max_index)
 {
+#if defined(USE_SSE41)
+   if (util_get_cpu_caps()->has_sse4_1) {
+      switch (index_size) {
+      case 4:
+         _mesa_uint_array_min_max((const GLuint *)indices, min_index,
+                                  max_index, count, restart, restartIndex);
+         return;
+      case 2:
+         _mesa_ushort_array_min_max((const GLushort *)indices, min_index,
+                                    max_index, count, restart, restartIndex);
+         return;
+      case 1:
+         _mesa_ubyte_array_min_max((const GLubyte *)indices, min_index,
+                                   max_index, count, restart, restartIndex);
+         return;
+      default:
+         unreachable("not reached");
+      }
+   }
+#endif
+
    switch (index_size) {
    case 4: {
       const GLuint *ui_indices = (const GLuint *)indices;
@@ -248,16 +269,10 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (util_get_cpu_caps()->has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (unsigned i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (unsigned i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
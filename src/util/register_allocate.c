@@ -71,11 +71,14 @@
  */
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "blob.h"
+#include "mesa-sha1.h"
 #include "ralloc.h"
 #include "util/bitset.h"
+#include "util/u_debug.h"
 #include "util/u_dynarray.h"
 #include "u_math.h"
 #include "register_allocate.h"
@@ -574,6 +577,12 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
    g->tmp.min_q_node = reralloc(g, g->tmp.min_q_node, unsigned int,
                                 bitset_count);
 
+   unsigned group_count = DIV_ROUND_UP(bitset_count, BITSET_WORDBITS);
+   g->tmp.group_min_q_total = reralloc(g, g->tmp.group_min_q_total,
+                                       unsigned int, group_count);
+   g->tmp.group_min_q_node = reralloc(g, g->tmp.group_min_q_node,
+                                      unsigned int, group_count);
+
    g->alloc = alloc;
 }
 
@@ -653,25 +662,50 @@ ra_reset_node_interference(struct ra_graph *g, unsigned int n)
    util_dynarray_clear(&g->nodes[n].adjacency_list);
 }
 
+/**
+ * Returns whether node n1 with the given q_total is a better candidate for
+ * optimistic coloring than node n2.
+ *
+ * In order to remain consistent with the old naive implementation of the
+ * algorithm, we do a lexicographical sort to ensure that we always choose the
+ * node with the highest node index.
+ */
+static inline bool
+ra_q_total_less(unsigned int q1, unsigned int n1,
+                unsigned int q2, unsigned int n2)
+{
+   return q1 < q2 || (q1 == q2 && n1 > n2);
+}
+
 static void
 update_pq_info(struct ra_graph *g, unsigned int n)
 {
    int i = n / BITSET_WORDBITS;
    int n_class = g->nodes[n].class;
-   if (g->nodes[n].tmp.q_total < g->regs->classes[n_class]->p) {
-      BITSET_SET(g->tmp.pq_test, n);
+   unsigned int q_total = g->nodes[n].tmp.q_total;
+   if (q_total < g->regs->classes[n_class]->p) {
+      if (!BITSET_TEST(g->tmp.pq_test, n)) {
+         BITSET_SET(g->tmp.pq_test, n);
+         if (!BITSET_TEST(g->tmp.reg_assigned, n))
+            g->tmp.pq_count++;
+      }
    } else if (g->tmp.min_q_total[i] != UINT_MAX) {
       /* Only update min_q_total and min_q_node if min_q_total != UINT_MAX so
        * that we don't update while we have stale data and accidentally mark
-       * it as non-stale.  Also, in order to remain consistent with the old
-       * naive implementation of the algorithm, we do a lexicographical sort
-       * to ensure that we always choose the node with the highest node index.
+       * it as non-stale.
        */
-      if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i] ||
-          (g->nodes[n].tmp.q_total == g->tmp.min_q_total[i] &&
-           n > g->tmp.min_q_node[i])) {
-         g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
+      if (ra_q_total_less(q_total, n, g->tmp.min_q_total[i],
+                          g->tmp.min_q_node[i])) {
+         g->tmp.min_q_total[i] = q_total;
          g->tmp.min_q_node[i] = n;
+
+         int gi = i / BITSET_WORDBITS;
+         if (g->tmp.group_min_q_total[gi] != UINT_MAX &&
+             ra_q_total_less(q_total, n, g->tmp.group_min_q_total[gi],
+                             g->tmp.group_min_q_node[gi])) {
+            g->tmp.group_min_q_total[gi] = q_total;
+            g->tmp.group_min_q_node[gi] = n;
+         }
       }
    }
 }
@@ -699,8 +733,77 @@ add_node_to_stack(struct ra_graph *g, unsigned int n)
    g->tmp.stack_count++;
    BITSET_SET(g->tmp.in_stack, n);
 
-   /* Flag the min_q_total for n's block as dirty so it gets recalculated */
+   if (BITSET_TEST(g->tmp.pq_test, n)) {
+      assert(g->tmp.pq_count > 0);
+      g->tmp.pq_count--;
+   }
+
+   /* Flag the min_q_total for n's word and group as dirty so they get
+    * recalculated.
+    */
    g->tmp.min_q_total[n / BITSET_WORDBITS] = UINT_MAX;
+   g->tmp.group_min_q_total[n / (BITSET_WORDBITS * BITSET_WORDBITS)] = UINT_MAX;
+}
+
+/**
+ * Returns the node with the lowest q_total which is neither in the stack nor
+ * pre-assigned, or UINT_MAX if there is none.  Only called when no such node
+ * passes the pq test.
+ */
+static unsigned int
+ra_find_optimistic_node(struct ra_graph *g)
+{
+   const unsigned int word_count = BITSET_WORDS(g->count);
+   const unsigned int top_word_high_bit = (g->count - 1) % BITSET_WORDBITS;
+   unsigned int min_q_total = UINT_MAX;
+   unsigned int min_q_node = UINT_MAX;
+
+   for (unsigned int gi = 0; gi * BITSET_WORDBITS < word_count; gi++) {
+      if (g->tmp.group_min_q_total[gi] == UINT_MAX) {
+         /* The group is dirty because we added one of its nodes to the
+          * stack.  It needs to be recalculated, along with its dirty words.
+          */
+         g->tmp.group_min_q_node[gi] = UINT_MAX;
+
+         const unsigned int word_end = MIN2(word_count,
+                                            (gi + 1) * BITSET_WORDBITS);
+         for (unsigned int i = gi * BITSET_WORDBITS; i < word_end; i++) {
+            if (g->tmp.min_q_total[i] == UINT_MAX) {
+               BITSET_WORD left = ~(g->tmp.in_stack[i] | g->tmp.reg_assigned[i]);
+               if (i == word_count - 1)
+                  left &= ~(BITSET_WORD)0 >> (31 - top_word_high_bit);
+
+               while (left) {
+                  unsigned int n = i * BITSET_WORDBITS + u_bit_scan(&left);
+                  if (ra_q_total_less(g->nodes[n].tmp.q_total, n,
+                                      g->tmp.min_q_total[i],
+                                      g->tmp.min_q_node[i])) {
+                     g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
+                     g->tmp.min_q_node[i] = n;
+                  }
+               }
+            }
+
+            if (g->tmp.min_q_total[i] != UINT_MAX &&
+                ra_q_total_less(g->tmp.min_q_total[i], g->tmp.min_q_node[i],
+                                g->tmp.group_min_q_total[gi],
+                                g->tmp.group_min_q_node[gi])) {
+               g->tmp.group_min_q_total[gi] = g->tmp.min_q_total[i];
+               g->tmp.group_min_q_node[gi] = g->tmp.min_q_node[i];
+            }
+         }
+      }
+
+      if (g->tmp.group_min_q_total[gi] != UINT_MAX &&
+          ra_q_total_less(g->tmp.group_min_q_total[gi],
+                          g->tmp.group_min_q_node[gi],
+                          min_q_total, min_q_node)) {
+         min_q_total = g->tmp.group_min_q_total[gi];
+         min_q_node = g->tmp.group_min_q_node[gi];
+      }
+   }
+
+   return min_q_node;
 }
 
 /**
@@ -726,6 +829,10 @@ ra_simplify(struct ra_graph *g)
 
    /* Do a quick pre-pass to set things up */
    g->tmp.stack_count = 0;
+   g->tmp.pq_count = 0;
+   for (int i = 0; i < DIV_ROUND_UP(BITSET_WORDS(g->count), BITSET_WORDBITS);
+        i++)
+      g->tmp.group_min_q_total[i] = UINT_MAX;
    for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
         i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
       g->tmp.in_stack[i] = 0;
@@ -744,26 +851,21 @@ ra_simplify(struct ra_graph *g)
    }
 
    while (progress) {
-      unsigned int min_q_total = UINT_MAX;
-      unsigned int min_q_node = UINT_MAX;
-
       progress = false;
 
+      /* Once there are no trivially colorable nodes left, we can stop
+       * looking for them.
+       */
       for (int i = BITSET_WORDS(g->count) - 1, high_bit = top_word_high_bit;
-           i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
-         BITSET_WORD mask = ~(BITSET_WORD)0 >> (31 - high_bit);
-
+           g->tmp.pq_count && i >= 0; i--, high_bit = BITSET_WORDBITS - 1) {
          BITSET_WORD skip = g->tmp.in_stack[i] | g->tmp.reg_assigned[i];
-         if (skip == mask)
-            continue;
-
          BITSET_WORD pq = g->tmp.pq_test[i] & ~skip;
          if (pq) {
             /* In this case, we have stuff we can immediately take off the
              * stack.  This also means that we're guaranteed to make progress
-             * and we don't need to bother updating lowest_q_total because we
-             * know we're going to loop again before attempting to do anything
-             * optimistic.
+             * and we don't need to bother looking for the lowest q_total
+             * because we know we're going to loop again before attempting to
+             * do anything optimistic.
              */
             for (int j = high_bit; j >= 0; j--) {
                if (pq & BITSET_BIT(j)) {
@@ -777,37 +879,18 @@ ra_simplify(struct ra_graph *g)
                   progress = true;
                }
             }
-         } else if (!progress) {
-            if (g->tmp.min_q_total[i] == UINT_MAX) {
-               /* The min_q_total and min_q_node are dirty because we added
-                * one of these nodes to the stack.  It needs to be
-                * recalculated.
-                */
-               for (int j = high_bit; j >= 0; j--) {
-                  if (skip & BITSET_BIT(j))
-                     continue;
-
-                  unsigned int n = i * BITSET_WORDBITS + j;
-                  assert(n < g->count);
-                  if (g->nodes[n].tmp.q_total < g->tmp.min_q_total[i]) {
-                     g->tmp.min_q_total[i] = g->nodes[n].tmp.q_total;
-                     g->tmp.min_q_node[i] = n;
-                  }
-               }
-            }
-            if (g->tmp.min_q_total[i] < min_q_total) {
-               min_q_node = g->tmp.min_q_node[i];
-               min_q_total = g->tmp.min_q_total[i];
-            }
          }
       }
 
-      if (!progress && min_q_total != UINT_MAX) {
-         if (stack_optimistic_start == UINT_MAX)
-            stack_optimistic_start = g->tmp.stack_count;
+      if (!progress) {
+         unsigned int n = ra_find_optimistic_node(g);
+         if (n != UINT_MAX) {
+            if (stack_optimistic_start == UINT_MAX)
+               stack_optimistic_start = g->tmp.stack_count;
 
-         add_node_to_stack(g, min_q_node);
-         progress = true;
+            add_node_to_stack(g, n);
+            progress = true;
+         }
       }
    }
 
@@ -975,9 +1058,123 @@ ra_select(struct ra_graph *g)
    return true;
 }
 
+/**
+ * Serializes the interference graph, including the class, forced register
+ * and spill cost of each node.  The register set and any register selection
+ * callback are not included.
+ */
+void
+ra_graph_serialize(const struct ra_graph *g, struct blob *blob)
+{
+   blob_write_uint32(blob, g->count);
+
+   for (unsigned int n = 0; n < g->count; n++) {
+      const struct ra_node *node = &g->nodes[n];
+      blob_write_uint32(blob, node->class);
+      blob_write_uint32(blob, node->forced_reg);
+      blob_write_uint32(blob, fui(node->spill_cost));
+
+      /* The order of the adjacency lists affects register selection, so
+       * keep it as is rather than rebuilding it from the adjacency bits.
+       */
+      blob_write_uint32(blob, util_dynarray_num_elements(&node->adjacency_list,
+                                                         unsigned int));
+      blob_write_bytes(blob, node->adjacency_list.data,
+                       node->adjacency_list.size);
+   }
+}
+
+/**
+ * Deserializes an interference graph written by ra_graph_serialize() for the
+ * given register set.  The graph is allocated the same way as by
+ * ra_alloc_interference_graph().
+ */
+struct ra_graph *
+ra_graph_deserialize(struct ra_regs *regs, struct blob_reader *blob)
+{
+   unsigned int count = blob_read_uint32(blob);
+   struct ra_graph *g = ra_alloc_interference_graph(regs, count);
+
+   for (unsigned int n = 0; n < count && !blob->overrun; n++) {
+      struct ra_node *node = &g->nodes[n];
+      node->class = blob_read_uint32(blob);
+      node->forced_reg = blob_read_uint32(blob);
+      node->spill_cost = uif(blob_read_uint32(blob));
+
+      unsigned int adjacency_count = blob_read_uint32(blob);
+      const unsigned int *adjacency =
+         blob_read_bytes(blob, adjacency_count * sizeof(unsigned int));
+      if (blob->overrun)
+         break;
+
+      assert(node->class < regs->class_count);
+      for (unsigned int i = 0; i < adjacency_count; i++) {
+         assert(adjacency[i] < count);
+         ra_set_adjacency_bit(g, n, adjacency[i]);
+      }
+      memcpy(util_dynarray_grow(&node->adjacency_list, unsigned int,
+                                adjacency_count),
+             adjacency, adjacency_count * sizeof(unsigned int));
+   }
+
+   /* The q totals depend on the classes of the neighbors, so they can only
+    * be computed once all the nodes have been read.
+    */
+   for (unsigned int n = 0; n < count && !blob->overrun; n++) {
+      struct ra_class *c = regs->classes[g->nodes[n].class];
+      util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p)
+         g->nodes[n].q_total += c->q[g->nodes[*n2p].class];
+   }
+
+   if (blob->overrun) {
+      ralloc_free(g);
+      return NULL;
+   }
+
+   return g;
+}
+
+DEBUG_GET_ONCE_OPTION(ra_graph_dump_dir, "MESA_RA_GRAPH_DUMP_DIR", NULL)
+
+/**
+ * Writes the register set and the interference graph to a file named after
+ * their SHA-1 in $MESA_RA_GRAPH_DUMP_DIR, to be replayed by ra_bench.
+ */
+static void
+ra_dump_graph(const struct ra_graph *g, const char *dir)
+{
+   struct blob blob;
+   blob_init(&blob);
+   ra_set_serialize(g->regs, &blob);
+   ra_graph_serialize(g, &blob);
+
+   if (!blob.out_of_memory) {
+      unsigned char sha1[SHA1_DIGEST_LENGTH];
+      char sha1_str[2 * SHA1_DIGEST_LENGTH + 1];
+      _mesa_sha1_compute(blob.data, blob.size, sha1);
+      _mesa_sha1_format(sha1_str, sha1);
+
+      char *path = ralloc_asprintf(NULL, "%s/%s.ra", dir, sha1_str);
+      FILE *f = fopen(path, "wb");
+      if (f) {
+         fwrite(blob.data, 1, blob.size, f);
+         fclose(f);
+      } else {
+         fprintf(stderr, "Failed to write %s\n", path);
+      }
+      ralloc_free(path);
+   }
+
+   blob_finish(&blob);
+}
+
 bool
 ra_allocate(struct ra_graph *g)
 {
+   const char *dump_dir = debug_get_option_ra_graph_dump_dir();
+   if (unlikely(dump_dir))
+      ra_dump_graph(g, dump_dir);
+
    ra_simplify(g);
    return ra_select(g);
 }
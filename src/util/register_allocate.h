@@ -120,6 +120,10 @@ void ra_add_node_interference(struct ra_graph *g,
 void ra_reset_node_interference(struct ra_graph *g, unsigned int n);
 /** @} */
 
+void ra_graph_serialize(const struct ra_graph *g, struct blob *blob);
+struct ra_graph *ra_graph_deserialize(struct ra_regs *regs,
+                                      struct blob_reader *blob);
+
 /** @{ Graph-coloring register allocation */
 bool ra_allocate(struct ra_graph *g);
 
@@ -161,6 +161,21 @@ struct ra_graph {
        */
       unsigned int *min_q_node;
 
+      /**
+       * Same as min_q_total and min_q_node for each group of BITSET_WORDBITS
+       * BITSET_WORDs, so that finding the node to optimistically push on the
+       * stack doesn't need to look at every word.  A group is marked unknown
+       * whenever one of its words is.
+       */
+      unsigned int *group_min_q_total;
+      unsigned int *group_min_q_node;
+
+      /**
+       * Number of nodes passing the pq test which are neither in the stack
+       * nor pre-assigned.
+       */
+      unsigned int pq_count;
+
       /**
        * Tracks the start of the set of optimistically-colored registers in the
        * stack.
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Replays interference graphs recorded with MESA_RA_GRAPH_DUMP_DIR through
+ * ra_allocate() and reports how long it takes.
+ *
+ *    MESA_RA_GRAPH_DUMP_DIR=/tmp/ra <run some shaders>
+ *    find /tmp/ra -name '*.ra' | xargs register_allocate_bench -r 20 > a.csv
+ *
+ * The output is CSV, one line per graph, so runs from two builds can be
+ * joined on the file name and compared.  The hash of the assigned registers
+ * is included to make sure both builds produced the same allocation.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/blob.h"
+#include "util/macros.h"
+#include "util/os_file.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/register_allocate.h"
+#include "util/register_allocate_internal.h"
+
+static void
+usage(const char *name)
+{
+   fprintf(stderr, "usage: %s [-r RUNS] FILE...\n", name);
+   exit(1);
+}
+
+static bool
+bench_file(const char *filename, unsigned runs)
+{
+   size_t size;
+   char *data = os_read_file(filename, &size);
+   if (!data) {
+      fprintf(stderr, "%s: failed to read file\n", filename);
+      return false;
+   }
+
+   void *mem_ctx = ralloc_context(NULL);
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, data, size);
+
+   struct ra_regs *regs = ra_set_deserialize(mem_ctx, &reader);
+   struct ra_graph *g = reader.overrun ? NULL :
+                        ra_graph_deserialize(regs, &reader);
+   if (!g || reader.current != reader.end) {
+      fprintf(stderr, "%s: not a register allocation graph\n", filename);
+      ralloc_free(mem_ctx);
+      free(data);
+      return false;
+   }
+   ralloc_steal(mem_ctx, g);
+
+   unsigned edges = 0;
+   for (unsigned n = 0; n < g->count; n++) {
+      edges += util_dynarray_num_elements(&g->nodes[n].adjacency_list,
+                                          unsigned int);
+   }
+
+   /* ra_allocate() starts over from the interference graph every time, so
+    * the same graph can be allocated repeatedly.
+    */
+   bool allocated = false;
+   int64_t best = INT64_MAX, total = 0;
+   for (unsigned i = 0; i < runs; i++) {
+      int64_t start = os_time_get_nano();
+      allocated = ra_allocate(g);
+      int64_t elapsed = os_time_get_nano() - start;
+
+      best = MIN2(best, elapsed);
+      total += elapsed;
+   }
+
+   uint32_t hash = 0;
+   for (unsigned n = 0; allocated && n < g->count; n++)
+      hash = hash * 31 + ra_get_node_reg(g, n);
+
+   printf("%s,%u,%u,%u,%s,%08x,%" PRId64 ",%" PRId64 "\n",
+          filename, regs->count, g->count, edges / 2,
+          allocated ? "yes" : "no", hash, best, total / runs);
+
+   ralloc_free(mem_ctx);
+   free(data);
+
+   return true;
+}
+
+int
+main(int argc, char **argv)
+{
+   unsigned runs = 10;
+   int i = 1;
+
+   for (; i < argc && argv[i][0] == '-'; i++) {
+      if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+         int n = atoi(argv[++i]);
+         runs = MAX2(n, 1);
+      } else {
+         usage(argv[0]);
+      }
+   }
+
+   if (i == argc)
+      usage(argv[0]);
+
+   printf("file,regs,nodes,edges,allocated,hash,best_ns,mean_ns\n");
+
+   bool ok = true;
+   for (; i < argc; i++)
+      ok &= bench_file(argv[i], runs);
+
+   return ok ? 0 : 1;
+}
@@ -279,3 +279,71 @@ TEST_F(ra_test, serialization_roundtrip)
    blob_finish(&blob);
 }
 
+TEST_F(ra_test, graph_serialization_roundtrip)
+{
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, 8, false);
+   struct ra_class *c1 = ra_alloc_contig_reg_class(regs, 1);
+   struct ra_class *c2 = ra_alloc_contig_reg_class(regs, 2);
+   for (int i = 0; i < 8; i++)
+      ra_class_add_reg(c1, i);
+   for (int i = 0; i < 8; i += 2)
+      ra_class_add_reg(c2, i);
+   ra_set_finalize(regs, NULL);
+
+   /* A ring of nodes that needs optimistic coloring, plus a forced one. */
+   const unsigned count = 12;
+   struct ra_graph *g = ra_alloc_interference_graph(regs, count);
+   ralloc_steal(mem_ctx, g);
+   ra_set_node_reg(g, 0, 3);
+   for (unsigned n = 1; n < count; n++) {
+      ra_set_node_class(g, n, n % 3 ? c1 : c2);
+      ra_set_node_spill_cost(g, n, n * 0.5f);
+   }
+   for (unsigned n = 1; n < count; n++) {
+      for (unsigned d = 1; d <= 3; d++)
+         ra_add_node_interference(g, n, 1 + (n + d - 1) % (count - 1));
+      if (n % 4 == 0)
+         ra_add_node_interference(g, 0, n);
+   }
+
+   struct blob blob;
+   blob_init(&blob);
+   ra_graph_serialize(g, &blob);
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, blob.data, blob.size);
+   struct ra_graph *g2 = ra_graph_deserialize(regs, &reader);
+   ASSERT_NE(g2, nullptr);
+   ralloc_steal(mem_ctx, g2);
+   EXPECT_EQ(reader.current, reader.end);
+
+   ASSERT_EQ(g2->count, g->count);
+   for (unsigned n = 0; n < count; n++) {
+      EXPECT_EQ(ra_get_node_class(g2, n), ra_get_node_class(g, n));
+      EXPECT_EQ(g2->nodes[n].forced_reg, g->nodes[n].forced_reg);
+      EXPECT_EQ(g2->nodes[n].q_total, g->nodes[n].q_total);
+      EXPECT_EQ(ra_debug_get_node_spill_cost(g2, n),
+                ra_debug_get_node_spill_cost(g, n));
+      ASSERT_EQ(g2->nodes[n].adjacency_list.size,
+                g->nodes[n].adjacency_list.size);
+      EXPECT_EQ(memcmp(g2->nodes[n].adjacency_list.data,
+                       g->nodes[n].adjacency_list.data,
+                       g->nodes[n].adjacency_list.size), 0);
+   }
+
+   /* Both graphs must end up with the same allocation. */
+   bool allocated = ra_allocate(g);
+   EXPECT_EQ(ra_allocate(g2), allocated);
+   if (allocated) {
+      for (unsigned n = 0; n < count; n++)
+         EXPECT_EQ(ra_get_node_reg(g2, n), ra_get_node_reg(g, n));
+   } else {
+      EXPECT_EQ(ra_get_best_spill_node(g2), ra_get_best_spill_node(g));
+   }
+
+   /* A truncated graph is rejected. */
+   blob_reader_init(&reader, blob.data, blob.size - 1);
+   EXPECT_EQ(ra_graph_deserialize(regs, &reader), nullptr);
+
+   blob_finish(&blob);
+}
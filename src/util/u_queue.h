@@ -293,6 +293,11 @@ struct util_queue_monitoring
    unsigned num_direct_items;
    unsigned num_syncs;
    unsigned num_batches;
+   unsigned stall_time_us;
+   unsigned max_queue_depth;
+
+   /* Current values set by the user of the queue. */
+   unsigned batch_size;
 };
 
 #ifdef __cplusplus